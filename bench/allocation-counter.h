@@ -0,0 +1,25 @@
+#pragma once
+#include <benchmark/benchmark.h>
+#include <cstddef>
+
+#include "../test/allocations.h"
+
+// Reports the heap allocations made while it lives as `allocs` per
+// iteration, make it right before the benchmark loop.
+class AllocationCounter final
+{
+public:
+  AllocationCounter(benchmark::State &state): state_(state), start_(Allocations()) { }
+
+  AllocationCounter(const AllocationCounter &) = delete;
+  AllocationCounter & operator = (const AllocationCounter &) = delete;
+
+  ~AllocationCounter() {
+    state_.counters["allocs"] = benchmark::Counter(
+      static_cast<double>(Allocations() - start_), benchmark::Counter::kAvgIterations);
+  }
+
+private:
+  benchmark::State &state_;
+  std::size_t start_;
+};
@@ -0,0 +1,35 @@
+#include <benchmark/benchmark.h>
+#include <vector>
+
+#include "../chain.h"
+#include "../pool-allocator.h"
+#include "./allocation-counter.h"
+
+// Adding an element and deleting it again through its deleter.
+template <typename A>
+static void ChainAddDelete(benchmark::State &state) {
+  Chain<int, A> chain;
+  AllocationCounter allocs(state);
+  for (auto _ : state) {
+    auto deleter = chain.Add(1);
+    benchmark::DoNotOptimize(deleter);
+  }
+}
+BENCHMARK(ChainAddDelete<std::allocator<int>>);
+BENCHMARK(ChainAddDelete<PoolAllocator<int>>);
+
+static void ChainForEach(benchmark::State &state) {
+  Chain<int> chain;
+  std::vector<Chain<int>::Deleter> deleters;
+  for (int i = 0; i < state.range(0); i++) {
+    deleters.push_back(chain.Add(int(i)));
+  }
+  AllocationCounter allocs(state);
+  for (auto _ : state) {
+    int sum = 0;
+    chain.ForEach([&sum](int n) { sum += n; });
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(ChainForEach)->Arg(1)->Arg(10)->Arg(1000);
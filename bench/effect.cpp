@@ -0,0 +1,83 @@
+#include <benchmark/benchmark.h>
+
+#include "../effect.h"
+#include "../pure-bind-monad.h"
+#include "../static-effect.h"
+#include "./allocation-counter.h"
+
+static void EffectBind(benchmark::State &state) {
+  auto x = Effect<int>::Pure(1);
+  AllocationCounter allocs(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(Monad<Effect>::Bind(x, [](int n) { return Effect<int>::Pure(n + 1); })());
+  }
+}
+BENCHMARK(EffectBind);
+
+static void EffectMap(benchmark::State &state) {
+  auto x = Effect<int>::Pure(1);
+  AllocationCounter allocs(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(Monad<Effect>::Map([](int n) { return n + 1; }, x)());
+  }
+}
+BENCHMARK(EffectMap);
+
+static void EffectLift(benchmark::State &state) {
+  auto x = Effect<int>::Pure(1), y = Effect<int>::Pure(2), z = Effect<int>::Pure(3);
+  AllocationCounter allocs(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(Monad<Effect>::Lift([](int a, int b, int c) { return a + b + c; }, x, y, z)());
+  }
+}
+BENCHMARK(EffectLift);
+
+static void EffectDeepBind(benchmark::State &state) {
+  AllocationCounter allocs(state);
+  for (auto _ : state) {
+    auto x = Effect<int>::Pure(0);
+    for (int i = 0; i < state.range(0); i++) {
+      x = Monad<Effect>::Bind(x, [](int n) { return Effect<int>::Pure(n + 1); });
+    }
+    benchmark::DoNotOptimize(x());
+  }
+}
+BENCHMARK(EffectDeepBind)->Arg(10)->Arg(1000)->Arg(100000);
+
+static void StaticEffectBindMap(benchmark::State &state) {
+  int x = 1;
+  auto eff = StaticEffect([&x]() { return x; })
+    .Bind([](int n) { return PureEffect(n + 1); })
+    .Map([](int n) { return n * 2; });
+  AllocationCounter allocs(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(x);
+    benchmark::DoNotOptimize(eff());
+  }
+}
+BENCHMARK(StaticEffectBindMap);
+
+// The handwritten lambda StaticEffectBindMap should compile down to.
+static void HandwrittenBindMap(benchmark::State &state) {
+  int x = 1;
+  auto eff = [&x]() { return (x + 1) * 2; };
+  AllocationCounter allocs(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(x);
+    benchmark::DoNotOptimize(eff());
+  }
+}
+BENCHMARK(HandwrittenBindMap);
+
+// Running a chain of `range(0)` maps.
+static void EffectMapChain(benchmark::State &state) {
+  auto x = Effect<int>::Pure(0);
+  for (int i = 0; i < state.range(0); i++) {
+    x = Monad<Effect>::Map([](int n) { return n + 1; }, x);
+  }
+  AllocationCounter allocs(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(x());
+  }
+}
+BENCHMARK(EffectMapChain)->Arg(1)->Arg(10)->Arg(100);
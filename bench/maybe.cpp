@@ -0,0 +1,146 @@
+#include <benchmark/benchmark.h>
+#include <vector>
+
+#include "../maybe.h"
+#include "../maybe-column.h"
+#include "../monad.h"
+#include "./allocation-counter.h"
+
+static void MaybeBind(benchmark::State &state) {
+  Maybe<int> x(1);
+  AllocationCounter allocs(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(Monad<Maybe>::Bind(x, [](int n) { return Maybe(n + 1); }));
+  }
+}
+BENCHMARK(MaybeBind);
+
+static void MaybeMap(benchmark::State &state) {
+  Maybe<int> x(1);
+  AllocationCounter allocs(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(Monad<Maybe>::Map([](int n) { return n + 1; }, x));
+  }
+}
+BENCHMARK(MaybeMap);
+
+static void MaybeLift(benchmark::State &state) {
+  Maybe<int> x(1), y(2), z(3);
+  AllocationCounter allocs(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(Monad<Maybe>::Lift([](int a, int b, int c) { return a + b + c; }, x, y, z));
+  }
+}
+BENCHMARK(MaybeLift);
+
+static void MaybeDeepBind(benchmark::State &state) {
+  AllocationCounter allocs(state);
+  for (auto _ : state) {
+    Maybe<int> x(0);
+    for (int i = 0; i < state.range(0); i++) {
+      x = Monad<Maybe>::Bind(x, [](int n) { return Maybe(n + 1); });
+      benchmark::DoNotOptimize(x);
+    }
+  }
+}
+BENCHMARK(MaybeDeepBind)->Arg(10)->Arg(1000)->Arg(100000);
+
+// An index which never reaches the maximum, its Maybe needs no flag.
+enum class Index: long { };
+
+template <>
+struct MaybeNiche<Index>: SentinelNiche<Index, Index(-1)> { };
+
+// Summing an array of `range(0)` maybe values, stored with a spare
+// representation (an opted-in sentinel or a NaN) or with a flag.
+template <typename T>
+static void MaybeArraySum(benchmark::State &state) {
+  std::vector<Maybe<T>> values;
+  for (int i = 0; i < state.range(0); i++) {
+    values.push_back(i % 3 == 0 ? Maybe<T>() : Maybe<T>(T(i)));
+  }
+  AllocationCounter allocs(state);
+  for (auto _ : state) {
+    long sum = 0;
+    for (const Maybe<T> &val : values) {
+      if (val) {
+        sum += static_cast<long>(val.Value());
+      }
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetBytesProcessed(state.iterations() * state.range(0) * sizeof(Maybe<T>));
+}
+BENCHMARK(MaybeArraySum<Index>)->Arg(1 << 24);
+BENCHMARK(MaybeArraySum<double>)->Arg(1 << 24);
+BENCHMARK(MaybeArraySum<long>)->Arg(1 << 24);
+
+// `x * 2 + 1` over `range(0)` rows a third of which are missing, row by
+// row or by column.
+static std::vector<Maybe<float>> Rows(std::size_t size, int missing) {
+  std::vector<Maybe<float>> rows;
+  for (std::size_t i = 0; i < size; i++) {
+    rows.push_back(i % missing == 0 ? Maybe<float>() : Maybe<float>(float(i)));
+  }
+  return rows;
+}
+
+static void MaybeRowsMap(benchmark::State &state) {
+  std::vector<Maybe<float>> rows = Rows(state.range(0), 3);
+  std::vector<Maybe<float>> out(rows.size());
+  AllocationCounter allocs(state);
+  for (auto _ : state) {
+    for (std::size_t i = 0; i < rows.size(); i++) {
+      out[i] = Monad<Maybe>::Map([](float x) { return x * 2 + 1; }, rows[i]);
+    }
+    benchmark::DoNotOptimize(out.data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(MaybeRowsMap)->Arg(1 << 16);
+
+static void MaybeColumnMap(benchmark::State &state) {
+  MaybeColumn<float> column(Rows(state.range(0), 3));
+  AllocationCounter allocs(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(column.Map([](float x) { return x * 2 + 1; }));
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(MaybeColumnMap)->Arg(1 << 16);
+
+static void MaybeColumnMapInPlace(benchmark::State &state) {
+  MaybeColumn<float> column(Rows(state.range(0), 3));
+  AllocationCounter allocs(state);
+  for (auto _ : state) {
+    column = std::move(column).Map([](float x) { return x * 0.5f + 1; });
+    benchmark::DoNotOptimize(column.Values().data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(MaybeColumnMapInPlace)->Arg(1 << 16);
+
+// `x * y + z` over three columns of `range(0)` rows.
+static void MaybeRowsLift(benchmark::State &state) {
+  std::vector<Maybe<float>> xs = Rows(state.range(0), 3), ys = Rows(state.range(0), 5), zs = Rows(state.range(0), 7);
+  std::vector<Maybe<float>> out(xs.size());
+  AllocationCounter allocs(state);
+  for (auto _ : state) {
+    for (std::size_t i = 0; i < xs.size(); i++) {
+      out[i] = Monad<Maybe>::Lift([](float x, float y, float z) { return x * y + z; }, xs[i], ys[i], zs[i]);
+    }
+    benchmark::DoNotOptimize(out.data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(MaybeRowsLift)->Arg(1 << 16);
+
+static void MaybeColumnLift(benchmark::State &state) {
+  MaybeColumn<float> xs(Rows(state.range(0), 3)), ys(Rows(state.range(0), 5)), zs(Rows(state.range(0), 7));
+  AllocationCounter allocs(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(Lift([](float x, float y, float z) { return x * y + z; }, xs, ys, zs));
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(MaybeColumnLift)->Arg(1 << 16);
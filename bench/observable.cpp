@@ -0,0 +1,187 @@
+#include <benchmark/benchmark.h>
+#include <vector>
+
+#include "../observable.h"
+#include "../monad.h"
+#include "./allocation-counter.h"
+
+static void ObservableBind(benchmark::State &state) {
+  auto x = Observable<int>(1);
+  AllocationCounter allocs(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(Monad<Observable>::Bind(x, [](int n) { return Observable<int>(n + 1); }).Value());
+  }
+}
+BENCHMARK(ObservableBind);
+
+static void ObservableMap(benchmark::State &state) {
+  auto x = Observable<int>(1);
+  AllocationCounter allocs(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(Monad<Observable>::Map([](int n) { return n + 1; }, x).Value());
+  }
+}
+BENCHMARK(ObservableMap);
+
+static void ObservableLift(benchmark::State &state) {
+  auto x = Observable<int>(1), y = Observable<int>(2), z = Observable<int>(3);
+  AllocationCounter allocs(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(Monad<Observable>::Lift([](int a, int b, int c) { return a + b + c; }, x, y, z).Value());
+  }
+}
+BENCHMARK(ObservableLift);
+
+// One update of a mutable observable notifying `range(0)` observers.
+static void ObservableNotify(benchmark::State &state) {
+  auto [x, updateX] = Observable<int>::Mutable(0);
+  int sum = 0;
+  std::vector<Observable<int>::Unobserve> unobs;
+  for (int i = 0; i < state.range(0); i++) {
+    unobs.push_back(x.Observe([&sum](int n, int) { sum += n; }));
+  }
+  int n = 0;
+  AllocationCounter allocs(state);
+  for (auto _ : state) {
+    updateX(++n);
+  }
+  benchmark::DoNotOptimize(sum);
+}
+BENCHMARK(ObservableNotify)->Arg(1)->Arg(10)->Arg(1000);
+
+// One update propagated through a chain of `range(0)` maps.
+static void ObservableDeepMap(benchmark::State &state) {
+  auto [x, updateX] = Observable<int>::Mutable(0);
+  Observable<int> y = x;
+  for (int i = 0; i < state.range(0); i++) {
+    y = Monad<Observable>::Map([](int n) { return n + 1; }, y);
+  }
+  int n = 0;
+  AllocationCounter allocs(state);
+  for (auto _ : state) {
+    updateX(++n);
+  }
+  benchmark::DoNotOptimize(y.Value());
+}
+BENCHMARK(ObservableDeepMap)->Arg(10)->Arg(1000);
+
+// One update of the first input of a three-input formula cell, built from
+// binds or combined.
+static void ObservableBindUpdate(benchmark::State &state) {
+  auto [x, updateX] = Observable<int>::Mutable(0);
+  auto y = Observable<int>(1), z = Observable<int>(2);
+  auto sum = Monad<Observable>::Bind(x, [y, z](int a) {
+    return Monad<Observable>::Bind(y, [z, a](int b) {
+      return Monad<Observable>::Map([a, b](int c) { return a + b + c; }, z);
+    });
+  });
+  int n = 0;
+  AllocationCounter allocs(state);
+  for (auto _ : state) {
+    updateX(++n);
+  }
+  benchmark::DoNotOptimize(sum.Value());
+}
+BENCHMARK(ObservableBindUpdate);
+
+static void ObservableCombineUpdate(benchmark::State &state) {
+  auto [x, updateX] = Observable<int>::Mutable(0);
+  auto y = Observable<int>(1), z = Observable<int>(2);
+  auto sum = Combine([](int a, int b, int c) { return a + b + c; }, x, y, z);
+  int n = 0;
+  AllocationCounter allocs(state);
+  for (auto _ : state) {
+    updateX(++n);
+  }
+  benchmark::DoNotOptimize(sum.Value());
+}
+BENCHMARK(ObservableCombineUpdate);
+
+// One update under a chain of `range(0)` lazy nodes nobody observes.
+static void ObservableLazyDeepMap(benchmark::State &state) {
+  auto [x, updateX] = Observable<int>::Mutable(0);
+  Observable<int> y = x;
+  for (int i = 0; i < state.range(0); i++) {
+    y = Lazy([](int n) { return n + 1; }, y);
+  }
+  int n = 0;
+  AllocationCounter allocs(state);
+  for (auto _ : state) {
+    updateX(++n);
+  }
+  benchmark::DoNotOptimize(y.Value());
+}
+BENCHMARK(ObservableLazyDeepMap)->Arg(10)->Arg(1000);
+
+// Changing an observed vector of `range(0)` elements, by replacing it
+// or in place.
+static void ObservableLargeUpdate(benchmark::State &state) {
+  auto [x, updateX] = Observable<std::vector<int>>::Mutable(std::vector<int>(state.range(0)));
+  auto unob = x.Observe([](const std::vector<int> &, const std::vector<int> &) { });
+  AllocationCounter allocs(state);
+  for (auto _ : state) {
+    std::vector<int> v = x.Value();
+    v.back() += 1;
+    updateX(std::move(v));
+  }
+}
+BENCHMARK(ObservableLargeUpdate)->Arg(1000)->Arg(100000);
+
+static void ObservableLargeModify(benchmark::State &state) {
+  auto [x, updateX] = Observable<std::vector<int>>::Mutable(std::vector<int>(state.range(0)));
+  auto unob = x.Observe([](const std::vector<int> &, const std::vector<int> &) { });
+  AllocationCounter allocs(state);
+  for (auto _ : state) {
+    updateX.Modify([](std::vector<int> &v) { v.back() += 1; });
+  }
+}
+BENCHMARK(ObservableLargeModify)->Arg(1000)->Arg(100000);
+
+// One update of a feed under a chain of 10 maps, directly or sampled
+// every 100 updates.
+static void ObservableSampledFeed(benchmark::State &state) {
+  ManualScheduler scheduler;
+  auto [x, updateX] = Observable<int>::Mutable(0);
+  Observable<int> y = Sample(x, std::chrono::microseconds(1000), scheduler);
+  for (int i = 0; i < 10; i++) {
+    y = Monad<Observable>::Map([](int n) { return n + 1; }, y);
+  }
+  int n = 0;
+  AllocationCounter allocs(state);
+  for (auto _ : state) {
+    updateX(++n);
+    scheduler.Advance(std::chrono::microseconds(10));
+  }
+  benchmark::DoNotOptimize(y.Value());
+}
+BENCHMARK(ObservableSampledFeed);
+
+// Subscribing and unsubscribing an observer, allocated or embedded in
+// its owner.
+static void ObservableObserveUnobserve(benchmark::State &state) {
+  auto x = Observable<int>(0);
+  int sum = 0;
+  AllocationCounter allocs(state);
+  for (auto _ : state) {
+    auto unob = x.Observe([&sum](int n, int) { sum += n; });
+    unob();
+  }
+  benchmark::DoNotOptimize(sum);
+}
+BENCHMARK(ObservableObserveUnobserve);
+
+static void ObservableHookObserve(benchmark::State &state) {
+  auto x = Observable<int>(0);
+  int sum = 0;
+  {
+    // The hook must not outlive `x`, it goes first.
+    Observable<int>::Hook hook([&sum](int n, int) { sum += n; });
+    AllocationCounter allocs(state);
+    for (auto _ : state) {
+      x.Observe(hook);
+      hook.Unobserve();
+    }
+  }
+  benchmark::DoNotOptimize(sum);
+}
+BENCHMARK(ObservableHookObserve);
@@ -0,0 +1,109 @@
+#include <benchmark/benchmark.h>
+
+#include "../reader.h"
+#include "../pure-bind-monad.h"
+#include "../static-reader.h"
+#include "./allocation-counter.h"
+
+using ToInt = Reader<int>::To<int>;
+
+static void ReaderBind(benchmark::State &state) {
+  auto x = ToInt([](int i) { return i + 1; });
+  AllocationCounter allocs(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(Monad<Reader<int>::To>::Bind(x, [](int n) { return ToInt::Pure(n + 1); })(1));
+  }
+}
+BENCHMARK(ReaderBind);
+
+static void ReaderMap(benchmark::State &state) {
+  auto x = ToInt([](int i) { return i + 1; });
+  AllocationCounter allocs(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(Monad<Reader<int>::To>::Map([](int n) { return n + 1; }, x)(1));
+  }
+}
+BENCHMARK(ReaderMap);
+
+static void ReaderLift(benchmark::State &state) {
+  auto x = ToInt([](int i) { return i + 1; });
+  auto y = ToInt([](int i) { return i + 2; });
+  auto z = ToInt([](int i) { return i + 3; });
+  AllocationCounter allocs(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(Monad<Reader<int>::To>::Lift([](int a, int b, int c) { return a + b + c; }, x, y, z)(1));
+  }
+}
+BENCHMARK(ReaderLift);
+
+static void ReaderDeepBind(benchmark::State &state) {
+  AllocationCounter allocs(state);
+  for (auto _ : state) {
+    auto x = ToInt([](int i) { return i; });
+    for (int i = 0; i < state.range(0); i++) {
+      x = Monad<Reader<int>::To>::Bind(x, [](int n) { return ToInt::Pure(n + 1); });
+    }
+    benchmark::DoNotOptimize(x(0));
+  }
+}
+BENCHMARK(ReaderDeepBind)->Arg(10)->Arg(1000)->Arg(100000);
+
+static void StaticReaderBindMap(benchmark::State &state) {
+  int input = 1;
+  auto r = StaticReader<int>::To([](int i) { return i + 1; })
+    .Bind([](int n) { return StaticReader<int>::To([n](int i) { return n + i; }); })
+    .Map([](int n) { return n * 2; });
+  AllocationCounter allocs(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(input);
+    benchmark::DoNotOptimize(r(input));
+  }
+}
+BENCHMARK(StaticReaderBindMap);
+
+// An expensive reader read with the same few environments, memoized or not.
+template <bool memoize>
+static void ReaderMemoize(benchmark::State &state) {
+  auto x = ToInt([](int i) {
+    int n = i;
+    for (int k = 0; k < 1000; k++) {
+      n = n * 31 + k;
+      benchmark::DoNotOptimize(n);
+    }
+    return n;
+  });
+  if constexpr (memoize) {
+    x = ToInt::Memoize(x, 4);
+  }
+  int i = 0;
+  AllocationCounter allocs(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(x(i++ % 4));
+  }
+}
+BENCHMARK(ReaderMemoize<false>)->Name("ReaderUncached");
+BENCHMARK(ReaderMemoize<true>)->Name("ReaderMemoized");
+
+// A sub-reader used three times in a lift, shared or not.
+template <bool share>
+static void ReaderShared(benchmark::State &state) {
+  auto x = ToInt([](int i) {
+    int n = i;
+    for (int k = 0; k < 1000; k++) {
+      n = n * 31 + k;
+      benchmark::DoNotOptimize(n);
+    }
+    return n;
+  });
+  if constexpr (share) {
+    x = ToInt::Shared(x);
+  }
+  auto r = Monad<Reader<int>::To>::Lift([](int a, int b, int c) { return a + b + c; }, x, x, x);
+  int i = 0;
+  AllocationCounter allocs(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(r(i++));
+  }
+}
+BENCHMARK(ReaderShared<false>)->Name("ReaderUnshared");
+BENCHMARK(ReaderShared<true>)->Name("ReaderShared");
@@ -0,0 +1,51 @@
+#include <benchmark/benchmark.h>
+
+#include "../task2.h"
+#include "../pure-bind-monad.h"
+#include "./allocation-counter.h"
+
+template <typename T>
+static T Await(const Task<T> &task) {
+  T result{};
+  task([&result](const T &val) { return [&result, val]() { result = val; }; })();
+  return result;
+}
+
+static void TaskBind(benchmark::State &state) {
+  auto x = Task<int>::Pure(1);
+  AllocationCounter allocs(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(Await(Monad<Task>::Bind(x, [](int n) { return Task<int>::Pure(n + 1); })));
+  }
+}
+BENCHMARK(TaskBind);
+
+static void TaskMap(benchmark::State &state) {
+  auto x = Task<int>::Pure(1);
+  AllocationCounter allocs(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(Await(Monad<Task>::Map([](int n) { return n + 1; }, x)));
+  }
+}
+BENCHMARK(TaskMap);
+
+static void TaskLift(benchmark::State &state) {
+  auto x = Task<int>::Pure(1), y = Task<int>::Pure(2), z = Task<int>::Pure(3);
+  AllocationCounter allocs(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(Await(Monad<Task>::Lift([](int a, int b, int c) { return a + b + c; }, x, y, z)));
+  }
+}
+BENCHMARK(TaskLift);
+
+static void TaskDeepBind(benchmark::State &state) {
+  AllocationCounter allocs(state);
+  for (auto _ : state) {
+    auto x = Task<int>::Pure(0);
+    for (int i = 0; i < state.range(0); i++) {
+      x = Monad<Task>::Bind(x, [](int n) { return Task<int>::Pure(n + 1); });
+    }
+    benchmark::DoNotOptimize(Await(x));
+  }
+}
+BENCHMARK(TaskDeepBind)->Arg(10)->Arg(1000)->Arg(100000);
@@ -1,8 +1,10 @@
 #pragma once
+#include <cstddef>
 #include <memory>
 #include <optional>
+#include <utility>
 
-template <typename T>
+template <typename T, typename Allocator = std::allocator<T>>
 class Chain
 {
 // Types
@@ -28,17 +30,45 @@ private:
       next_ = this;
     }
 
+    // The markers of ForEach live on its stack. GCC warns that the chain
+    // keeps their addresses, but a marker unlinks itself in its destructor
+    // before it goes out of scope.
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 12
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdangling-pointer"
+#endif
+    // Swaps this node with the one after it, which must not be this one.
+    void StepOver() {
+      Node *prev = prev_;
+      Node *node = next_;
+      Node *next = node->next_;
+      prev->next_ = node;
+      node->prev_ = prev;
+      node->next_ = this;
+      prev_ = node;
+      next_ = next;
+      next->prev_ = this;
+    }
+
     void InsertBefore(Node &node) {
       prev_ = node.prev_;
       next_ = &node;
       node.prev_->next_ = this;
       node.prev_ = this;
     }
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 12
+#pragma GCC diagnostic pop
+#endif
 
-    const Node *Next() const {
+    Node *Next() const {
       return next_;
     }
 
+    // The head and the markers of the iterations carry no value.
+    bool HasValue() const {
+      return payload_.has_value();
+    }
+
     const T &Value() const {
       return payload_.value();
     }
@@ -49,50 +79,119 @@ private:
     std::optional<T> payload_;
   };
 
+  using NodeAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Node>;
+  using NodeTraits = std::allocator_traits<NodeAllocator>;
+
 public:
   class Deleter
   {
   public:
-    Deleter(std::unique_ptr<Node> ptr): ptr_(std::move(ptr)) {}
+    Deleter(Node *ptr, const NodeAllocator &alloc): ptr_(ptr), alloc_(alloc) {}
 
-    Deleter(Deleter &&del) = default;
+    Deleter(Deleter &&del): ptr_(std::exchange(del.ptr_, nullptr)), alloc_(del.alloc_) {}
     Deleter& operator = (Deleter &&del) {
       (*this)();
-      ptr_ = std::move(del.ptr_);
+      ptr_ = std::exchange(del.ptr_, nullptr);
+      alloc_ = del.alloc_;
       return *this;
     }
 
     Deleter(const Deleter &) = delete;
     Deleter& operator = (const Deleter &) = delete;
 
-    void operator () () { ptr_ = nullptr; }
+    ~Deleter() { (*this)(); }
+
+    void operator () () {
+      if (ptr_ != nullptr) {
+        NodeTraits::destroy(alloc_, ptr_);
+        NodeTraits::deallocate(alloc_, ptr_, 1);
+        ptr_ = nullptr;
+      }
+    }
+
+  private:
+    Node *ptr_;
+    [[no_unique_address]] NodeAllocator alloc_;
+  };
+
+  // A node its owner embeds rather than one allocated by Add. It leaves
+  // the chain when unlinked or destroyed.
+  class Hook final: private Node
+  {
+  public:
+    Hook(T &&value): Node(std::forward<T>(value)) { }
+
+    Hook(const Hook &) = delete;
+    Hook & operator = (const Hook &) = delete;
+
+    void Unlink() { this->Isolate(); }
+
+    bool Linked() const { return this->Next() != this; }
 
   private:
-    std::unique_ptr<Node> ptr_;
+    friend class Chain;
   };
 
+  Chain(const Allocator &alloc = Allocator()): alloc_(alloc), head_(), clears_(0) {}
+
   // Methods
 public:
   Deleter Add(T &&value) {
-    std::unique_ptr<Node> node = std::make_unique<Node>(std::forward<T>(value));
+    Node *node = NodeTraits::allocate(alloc_, 1);
+    try {
+      NodeTraits::construct(alloc_, node, std::forward<T>(value));
+    } catch (...) {
+      NodeTraits::deallocate(alloc_, node, 1);
+      throw;
+    }
     node->InsertBefore(head_);
-    return Deleter(std::move(node));
+    return Deleter(node, alloc_);
+  }
+
+  // Links `hook` at the end, moving it from where it was linked.
+  void Link(Hook &hook) {
+    hook.Isolate();
+    hook.InsertBefore(head_);
   }
 
+  // Detaches all the elements, which also ends the iterations running.
   void Clear() {
     head_.Isolate();
+    clears_ += 1;
   }
 
+  // Visits the elements in order. `f` may remove any element, including
+  // the one it is called with, and add elements, which this iteration
+  // doesn't visit. Clearing the chain ends the iteration. Two marker
+  // nodes on the stack keep the place: a cursor right after the element
+  // being visited and the end of the elements when the iteration started.
+  //
+  // The end marker costs two links per iteration, the cursor steps over
+  // every element, which is what lets `f` remove the element it is called
+  // with or the next one.
+  //
+  // A removed element is destroyed right away. Once `f` removed the
+  // element it is called with (e.g. an observer unobserving itself), it
+  // must not touch that element, such as its captures, any more.
   template <typename F>
   void ForEach(F &&f) const {
-    const Node *ptr = head_.Next();
-    while (ptr != &head_) {
-      f(ptr->Value());
-      ptr = ptr->Next();
+    Node end;
+    end.InsertBefore(head_);
+    Node cursor;
+    cursor.InsertBefore(*head_.Next());
+    std::size_t clears = clears_;
+    for (Node *ptr = cursor.Next(); ptr != &end && clears_ == clears; ptr = cursor.Next()) {
+      cursor.StepOver();
+      if (ptr->HasValue()) {
+        f(ptr->Value());
+      }
     }
   }
 
 // Members
 private:
-  Node head_;
+  [[no_unique_address]] NodeAllocator alloc_;
+  // Mutable for the markers of the iterations.
+  mutable Node head_;
+  std::size_t clears_;
 };
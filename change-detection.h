@@ -0,0 +1,47 @@
+#pragma once
+#include <cstddef>
+#include <functional>
+
+// Policies deciding whether a new value of an observable differs from its
+// old one, observers and dependents only hear of changes.
+//
+// An observable of T uses ChangeDetection<T>, which compares the values.
+// Specialize it to pick a cheaper policy for large values, e.g.
+//
+//   template <> struct ChangeDetection<Document>: CompareVersions { };
+//
+// or to supply any type with a static `Changed(oldVal, newVal)`.
+
+// Deep comparison with `!=`.
+struct CompareValues
+{
+  template <typename T>
+  static bool Changed(const T &oldVal, const T &newVal) { return newVal != oldVal; }
+};
+
+// Every update is a change, nothing is compared.
+struct AlwaysChanged
+{
+  template <typename T>
+  static bool Changed(const T &, const T &) { return true; }
+};
+
+// Values carrying a generation counter, bumped by whoever modifies them,
+// compare only their `Version()`.
+struct CompareVersions
+{
+  template <typename T>
+  static bool Changed(const T &oldVal, const T &newVal) { return newVal.Version() != oldVal.Version(); }
+};
+
+// Compares the hashes of the values, for values cheaper to hash than to
+// compare. Equal hashes are taken as equal values.
+template <typename Hash>
+struct CompareHashes
+{
+  template <typename T>
+  static bool Changed(const T &oldVal, const T &newVal) { return Hash()(newVal) != Hash()(oldVal); }
+};
+
+template <typename T>
+struct ChangeDetection: CompareValues { };
@@ -0,0 +1,210 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <vector>
+
+// A thread-safe counterpart of Observable.
+//
+// The observers are kept in an immutable snapshot which is replaced on
+// every subscription change (copy-on-write, RCU-style). Notifying only
+// loads the current snapshot, so observers can subscribe from any thread
+// without waiting for a notification to finish, and a notification never
+// waits for a subscription change.
+//
+// Unsubscribing waits for the notifications in flight, so the captures
+// of an observer may be released as soon as it is unsubscribed. An
+// observer unsubscribing from within a notification of the same subject
+// doesn't wait for it, and may still receive that last notification.
+// Unsubscribing from within a notification of another subject must not
+// race with the reverse, or both wait for each other.
+//
+// Updates to one subject are serialized, so the observers see the
+// values in the order they were committed.
+template <typename T>
+class ConcurrentObservable final
+{
+public:
+  using Observer = std::function<void(const T &, const T &)>;
+  using Observers = std::vector<std::shared_ptr<const Observer>>;
+
+  class Subject
+  {
+  public:
+    Subject(const T &value):
+      value_(std::make_shared<const T>(value)),
+      obs_(std::make_shared<const Observers>()) {}
+
+    Subject(const Subject &) = delete;
+    Subject & operator = (const Subject &) = delete;
+
+    virtual ~Subject() = default;
+
+    template <typename F>
+    std::shared_ptr<const Observer> Observe(const F &ob) {
+      auto entry = std::make_shared<const Observer>(ob);
+      Modify([&entry](Observers &obs) { obs.push_back(entry); });
+      return entry;
+    }
+
+    // Observes with `ob` and calls `sync` with the current value, no update
+    // is committed in between.
+    template <typename F, typename S>
+    std::shared_ptr<const Observer> Observe(const F &ob, S &&sync) {
+      std::lock_guard<std::recursive_mutex> lock(update_);
+      std::shared_ptr<const Observer> entry = Observe(ob);
+      sync(*value_.load());
+      return entry;
+    }
+
+    // Returns once the notifications in flight are done, see above.
+    void Unobserve(const std::shared_ptr<const Observer> &entry) {
+      Modify([&entry](Observers &obs) {
+        obs.erase(std::remove(obs.begin(), obs.end(), entry), obs.end());
+      });
+      std::lock_guard<std::recursive_mutex> wait(update_);
+    }
+
+    T Value() const { return *value_.load(); }
+
+    void Notify(const T &value) {
+      std::lock_guard<std::recursive_mutex> lock(update_);
+      std::shared_ptr<const T> old = value_.load();
+      if (value != *old) {
+        std::shared_ptr<const Observers> obs = obs_.load();
+        for (const auto &ob : *obs) {
+          (*ob)(value, *old);
+        }
+        value_.store(std::make_shared<const T>(value));
+      }
+    }
+
+  private:
+    template <typename F>
+    void Modify(F &&f) {
+      std::lock_guard<std::mutex> lock(subscribe_);
+      auto obs = std::make_shared<Observers>(*obs_.load());
+      f(*obs);
+      obs_.store(std::shared_ptr<const Observers>(std::move(obs)));
+    }
+
+    std::atomic<std::shared_ptr<const T>> value_;
+    std::atomic<std::shared_ptr<const Observers>> obs_;
+    std::recursive_mutex update_;
+    std::mutex subscribe_;
+  };
+
+  class Unobserve
+  {
+  public:
+    Unobserve(std::shared_ptr<Subject> subject, std::shared_ptr<const Observer> entry)
+      : subject_(std::move(subject)), entry_(std::move(entry)) { }
+
+    Unobserve(const Unobserve &) = delete;
+    Unobserve& operator = (const Unobserve &) = delete;
+
+    Unobserve(Unobserve &&unob): subject_(std::move(unob.subject_)), entry_(std::move(unob.entry_)) { }
+    Unobserve& operator = (Unobserve &&unob) {
+      Detach();
+      subject_ = std::move(unob.subject_);
+      entry_ = std::move(unob.entry_);
+      return *this;
+    }
+
+    ~Unobserve() { Detach(); }
+
+    ConcurrentObservable<T> operator () () {
+      Detach();
+      return ConcurrentObservable<T>(subject_);
+    }
+
+  private:
+    void Detach() {
+      if (subject_ && entry_) {
+        subject_->Unobserve(entry_);
+        entry_ = nullptr;
+      }
+    }
+
+    std::shared_ptr<Subject> subject_;
+    std::shared_ptr<const Observer> entry_;
+  };
+
+  // The upstream observer only holds a weak reference, a derived subject
+  // released by its last owner stops receiving notifications.
+  template <typename U>
+  class MapSubject: public Subject
+  {
+  public:
+    template <typename F>
+    MapSubject(const F &func, const ConcurrentObservable<U> &ob):
+      Subject(func(ob.Value())), unob_(std::nullopt) { }
+
+    template <typename F>
+    static std::shared_ptr<Subject> Make(const F &func, const ConcurrentObservable<U> &ob) {
+      auto subject = std::make_shared<MapSubject>(func, ob);
+      std::weak_ptr<MapSubject> weak = subject;
+      // Catch up with any update committed before the subscription.
+      auto entry = ob.subject_->Observe([weak, func](const U &val, const U &) {
+        if (auto self = weak.lock()) {
+          self->Notify(func(val));
+        }
+      }, [&subject, &func](const U &val) { subject->Notify(func(val)); });
+      subject->unob_.emplace(ob.subject_, std::move(entry));
+      return subject;
+    }
+
+  private:
+    std::optional<typename ConcurrentObservable<U>::Unobserve> unob_;
+  };
+
+  class Updater
+  {
+  public:
+    Updater(std::shared_ptr<Subject> subject): subject_(subject) { }
+    void operator () (const T &val) const { subject_->Notify(val); }
+  private:
+    std::shared_ptr<Subject> subject_;
+  };
+
+private:
+  template <typename> friend class ConcurrentObservable;
+
+  ConcurrentObservable(std::shared_ptr<Subject> subject) : subject_(subject) {}
+
+public:
+  // Functor::Map
+  template <typename F, typename U>
+  ConcurrentObservable(const F &f, const ConcurrentObservable<U> &val):
+    ConcurrentObservable(MapSubject<U>::Make(f, val)) { }
+  // Monad::Pure
+  ConcurrentObservable(const T &value): ConcurrentObservable(std::make_shared<Subject>(value)) { }
+
+  // Comparable
+  bool operator == (const ConcurrentObservable<T> &ob) const {
+    return subject_ == ob.subject_;
+  }
+
+  // Unobserving waits for the notifications of `f` in flight, see above.
+  template <typename F>
+  Unobserve Observe(const F &f) const {
+    return Unobserve(subject_, subject_->Observe(f));
+  }
+
+  T Value() const {
+    return subject_->Value();
+  }
+
+private:
+  std::shared_ptr<Subject> subject_;
+
+public:
+  static std::pair<ConcurrentObservable<T>, Updater> Mutable(const T &value) {
+    auto subject = std::make_shared<Subject>(value);
+    return std::make_pair(ConcurrentObservable<T>(subject), Updater(subject));
+  }
+};
@@ -0,0 +1,299 @@
+#pragma once
+#include <atomic>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <new>
+#include <optional>
+#include <stdexcept>
+#include <stop_token>
+#include <type_traits>
+#include <utility>
+
+#include "effect.h"
+#include "task2.h"
+
+// The frames of the coroutines. An allocator may be passed as the leading
+// `std::allocator_arg, alloc` parameters of a coroutine, the frame then
+// records how to release itself behind its end.
+class CoroutineFrame final
+{
+public:
+  static void *Allocate(std::size_t size) {
+    return Allocate(size, std::allocator<std::byte>());
+  }
+
+  template <typename Alloc>
+  static void *Allocate(std::size_t size, const Alloc &alloc) {
+    using Blocks = typename std::allocator_traits<Alloc>::template rebind_alloc<Block>;
+    Blocks blocks(alloc);
+    std::byte *frame = reinterpret_cast<std::byte *>(std::allocator_traits<Blocks>::allocate(blocks, Count<Blocks>(size)));
+    new (frame + DeallocateOffset(size)) Deallocate(&Release<Blocks>);
+    new (frame + AllocatorOffset<Blocks>(size)) Blocks(std::move(blocks));
+    return frame;
+  }
+
+  static void Release(void *ptr, std::size_t size) {
+    std::byte *frame = static_cast<std::byte *>(ptr);
+    (*std::launder(reinterpret_cast<Deallocate *>(frame + DeallocateOffset(size))))(frame, size);
+  }
+
+private:
+  struct alignas(__STDCPP_DEFAULT_NEW_ALIGNMENT__) Block {
+    std::byte bytes[__STDCPP_DEFAULT_NEW_ALIGNMENT__];
+  };
+
+  using Deallocate = void (*)(std::byte *, std::size_t);
+
+  static constexpr std::size_t RoundUp(std::size_t size, std::size_t align) {
+    return (size + align - 1) / align * align;
+  }
+
+  static constexpr std::size_t DeallocateOffset(std::size_t size) {
+    return RoundUp(size, alignof(Deallocate));
+  }
+
+  template <typename Blocks>
+  static constexpr std::size_t AllocatorOffset(std::size_t size) {
+    return RoundUp(DeallocateOffset(size) + sizeof(Deallocate), alignof(Blocks));
+  }
+
+  template <typename Blocks>
+  static constexpr std::size_t Count(std::size_t size) {
+    return RoundUp(AllocatorOffset<Blocks>(size) + sizeof(Blocks), sizeof(Block)) / sizeof(Block);
+  }
+
+  template <typename Blocks>
+  static void Release(std::byte *frame, std::size_t size) {
+    Blocks *stored = std::launder(reinterpret_cast<Blocks *>(frame + AllocatorOffset<Blocks>(size)));
+    Blocks blocks(std::move(*stored));
+    stored->~Blocks();
+    std::allocator_traits<Blocks>::deallocate(blocks, reinterpret_cast<Block *>(frame), Count<Blocks>(size));
+  }
+};
+
+// Finds the allocator passed to a coroutine taking `Args`, either as its
+// leading parameters or right after the object of a member coroutine.
+template <typename... Args>
+struct FrameAllocator
+{
+  static constexpr bool allocated = false;
+};
+
+template <typename Alloc, typename... Args>
+struct FrameAllocator<std::allocator_arg_t, Alloc, Args...>
+{
+  static constexpr bool allocated = true;
+  static const Alloc &Get(const std::allocator_arg_t &, const Alloc &alloc, const Args &...) { return alloc; }
+};
+
+template <typename This, typename Alloc, typename... Args>
+struct FrameAllocator<This, std::allocator_arg_t, Alloc, Args...>
+{
+  static constexpr bool allocated = true;
+  static const Alloc &Get(const This &, const std::allocator_arg_t &, const Alloc &alloc, const Args &...) { return alloc; }
+};
+
+// The promise of a coroutine returning Task<T> and taking `Args`. The task
+// starts the coroutine when it is run, so it can only run once (running
+// it again throws std::logic_error), and completes
+// it with the value of `co_return`. The tasks it awaits run under its stop
+// token, once stopped it doesn't call back.
+//
+// The promise is specific to `Args` so that its allocation functions
+// aren't templates, and pair with its deallocation function.
+template <typename T, typename... Args>
+class TaskPromise
+{
+public:
+  using Callback = typename Task<T>::Callback;
+
+  // Owns the frame until the coroutine is started, it then releases
+  // itself when it completes.
+  class Frame
+  {
+  public:
+    Frame(std::coroutine_handle<TaskPromise> handle): handle_(handle), started_(false) { }
+
+    Frame(const Frame &) = delete;
+    Frame & operator = (const Frame &) = delete;
+
+    ~Frame() {
+      if (!started_.load()) {
+        handle_.destroy();
+      }
+    }
+
+    typename Task<T>::UnitEffect Start(const Callback &cb, const std::stop_token &token) {
+      if (token.stop_requested()) {
+        return typename Task<T>::UnitEffect([] {});
+      }
+      if (started_.exchange(true)) {
+        throw std::logic_error("Task: a coroutine task only runs once");
+      }
+      handle_.promise().cb_.emplace(cb);
+      handle_.promise().token_ = token;
+      handle_.resume();
+      return typename Task<T>::UnitEffect([] {});
+    }
+
+  private:
+    std::coroutine_handle<TaskPromise> handle_;
+    std::atomic<bool> started_;
+  };
+
+  Task<T> get_return_object() {
+    auto frame = std::make_shared<Frame>(std::coroutine_handle<TaskPromise>::from_promise(*this));
+    return Task<T>([frame](const Callback &cb, const std::stop_token &token) {
+      return frame->Start(cb, token);
+    });
+  }
+
+  std::suspend_always initial_suspend() noexcept { return {}; }
+  std::suspend_never final_suspend() noexcept { return {}; }
+
+  void return_value(const T &val) {
+    if (!token_.stop_requested()) {
+      cb_.value()(val)();
+    }
+  }
+
+  const std::stop_token &Token() const { return token_; }
+
+  void unhandled_exception() { std::terminate(); }
+
+  static void *operator new(std::size_t size) {
+    return CoroutineFrame::Allocate(size);
+  }
+
+  static void *operator new(std::size_t size, const Args &... args) requires FrameAllocator<Args...>::allocated {
+    return CoroutineFrame::Allocate(size, FrameAllocator<Args...>::Get(args...));
+  }
+
+  static void operator delete(void *ptr, std::size_t size) {
+    CoroutineFrame::Release(ptr, size);
+  }
+
+private:
+  std::optional<Callback> cb_;
+  std::stop_token token_;
+};
+
+template <typename T, typename... Args>
+struct std::coroutine_traits<Task<T>, Args...>
+{
+  using promise_type = TaskPromise<T, std::remove_cvref_t<Args>...>;
+};
+
+// Awaits a task from a coroutine. A task made by Pure doesn't suspend the
+// coroutine at all, nor does any other task completing synchronously. One
+// completing later resumes the coroutine from its callback, on the thread
+// calling back. A task dropping its callback without calling back, as a
+// stopped one does, destroys the coroutine.
+//
+// The continuation lives in the callback itself, the task and its effect
+// run right away, so awaiting costs the one allocation of the callback.
+template <typename T>
+class TaskAwaiter
+{
+public:
+  TaskAwaiter(const Task<T> &task): task_(task), ready_(task.Ready()), value_(std::nullopt), done_(false) { }
+
+  bool await_ready() const noexcept { return ready_ != nullptr; }
+
+  template <typename Promise>
+  bool await_suspend(std::coroutine_handle<Promise> handle) {
+    std::stop_token token;
+    if constexpr (requires { handle.promise().Token(); }) {
+      token = handle.promise().Token();
+    }
+    task_.Start(typename Task<T>::Callback(Continuation(this, handle)), token);
+    // Nothing of the frame may be touched once the callback may resume it.
+    if (!done_.exchange(true)) {
+      return true;
+    }
+    if (value_.has_value()) {
+      return false;
+    }
+    handle.destroy();
+    return true;
+  }
+
+  T await_resume() { return ready_ != nullptr ? *ready_ : std::move(value_.value()); }
+
+private:
+  // Held once by the callback, whose copies share it. Settles the
+  // coroutine when called or when the last copy of the callback goes.
+  class Continuation
+  {
+  public:
+    Continuation(TaskAwaiter *awaiter, std::coroutine_handle<> handle): awaiter_(awaiter), handle_(handle) { }
+
+    Continuation(Continuation &&cont): awaiter_(std::exchange(cont.awaiter_, nullptr)), handle_(cont.handle_) { }
+
+    Continuation(const Continuation &) = delete;
+    Continuation & operator = (const Continuation &) = delete;
+
+    ~Continuation() {
+      if (awaiter_ != nullptr) {
+        awaiter_->Settle(handle_);
+      }
+    }
+
+    typename Task<T>::UnitEffect operator () (const T &val) {
+      if (TaskAwaiter *awaiter = std::exchange(awaiter_, nullptr)) {
+        awaiter->value_.emplace(val);
+        awaiter->Settle(handle_);
+      }
+      return typename Task<T>::UnitEffect([] {});
+    }
+
+  private:
+    TaskAwaiter *awaiter_;
+    std::coroutine_handle<> handle_;
+  };
+
+  // The second of the callback and `await_suspend` to get here goes on
+  // with the coroutine.
+  void Settle(std::coroutine_handle<> handle) {
+    if (!done_.exchange(true)) {
+      return;
+    }
+    if (value_.has_value()) {
+      handle.resume();
+    } else {
+      handle.destroy();
+    }
+  }
+
+  Task<T> task_;
+  const T *ready_;
+  std::optional<T> value_;
+  std::atomic<bool> done_;
+};
+
+template <typename T>
+TaskAwaiter<T> operator co_await(const Task<T> &task) {
+  return TaskAwaiter<T>(task);
+}
+
+// Effects are synchronous, awaiting one just runs it.
+template <typename T>
+class EffectAwaiter
+{
+public:
+  EffectAwaiter(const Effect<T> &eff): eff_(eff) { }
+
+  bool await_ready() const noexcept { return true; }
+  void await_suspend(std::coroutine_handle<>) const noexcept { }
+  T await_resume() const { return eff_(); }
+
+private:
+  Effect<T> eff_;
+};
+
+template <typename T>
+EffectAwaiter<T> operator co_await(const Effect<T> &eff) {
+  return EffectAwaiter<T>(eff);
+}
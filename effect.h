@@ -1,6 +1,13 @@
 #pragma once
+#include <cstddef>
 #include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
 #include <variant>
+#include <vector>
+
+#include "./trampoline.h"
 
 template <typename F>
 concept returning_void = std::is_same_v<std::invoke_result_t<F>, void>;
@@ -9,40 +16,161 @@ template <typename T = std::monostate>
 class Effect final
 {
 private:
-  class IEffect {
+  template <typename> friend class Effect;
+
+  using Engine = Trampoline<Erased()>;
+
+  struct Storage {
+    alignas(void *) std::byte bytes[4 * sizeof(void *)];
+  };
+
+  struct VTable {
+    T (*invoke)(const Storage &);
+    void (*copy)(const Storage &, Storage &);
+    void (*move)(Storage &, Storage &);
+    void (*destroy)(Storage &);
+    const Engine::Step *(*step)(const Storage &);
+  };
+
+  // A chain of binds, run by the trampoline in constant stack space.
+  class Bound {
   public:
-    virtual ~IEffect() = default;
-    virtual T operator () () = 0;
+    Bound(Engine::Step step): step_(std::move(step)) {}
+    T operator () () const { return Engine::Run(step_).Take<T>(); }
+    const Engine::Step &Step() const { return step_; }
+  private:
+    Engine::Step step_;
+  };
+
+  template <typename F>
+  struct Inline {
+    static const F &Get(const Storage &s) { return *std::launder(reinterpret_cast<const F *>(s.bytes)); }
+    static F &Get(Storage &s) { return *std::launder(reinterpret_cast<F *>(s.bytes)); }
+
+    static constexpr VTable vtable = {
+      [](const Storage &s) -> T { return Get(s)(); },
+      [](const Storage &src, Storage &dst) { new (dst.bytes) F(Get(src)); },
+      [](Storage &src, Storage &dst) { new (dst.bytes) F(std::move(Get(src))); },
+      [](Storage &s) { Get(s).~F(); },
+      [](const Storage &s) -> const Engine::Step * {
+        if constexpr (std::is_same_v<F, Bound>) {
+          return &Get(s).Step();
+        } else {
+          return nullptr;
+        }
+      },
+    };
   };
 
+  // Callables which are large, move-only or mutate their own state are
+  // shared between the copies, like they all used to be.
   template <typename F>
-  class EffectImpl: public IEffect {
+  class Shared {
   public:
-    EffectImpl(F &&f): f_(std::forward<F>(f)) {}
-    virtual T operator() () override { return f_(); }
+    template <typename A>
+    Shared(A &&f): ptr_(std::make_shared<F>(std::forward<A>(f))) {}
+    T operator () () const { return (*ptr_)(); }
   private:
-    F f_;
+    std::shared_ptr<F> ptr_;
   };
 
-  std::shared_ptr<IEffect> ptr_;
+  // Small callables invocable as const can't tell being copied from being
+  // shared, they are stored inline without any allocation.
+  template <typename F>
+  static constexpr bool inlined =
+    sizeof(F) <= sizeof(Storage) &&
+    alignof(F) <= alignof(Storage) &&
+    std::is_nothrow_move_constructible_v<F> &&
+    std::is_copy_constructible_v<F> &&
+    std::is_invocable_r_v<T, const F &>;
+
+  template <typename F>
+  struct Unit {
+    T operator () () { f(); return T(); }
+    T operator () () const requires std::is_invocable_v<const F &> { f(); return T(); }
+    F f;
+  };
+
+  // Constructs the callable in `storage_` and returns its vtable.
+  template <typename F, typename A>
+  const VTable *Emplace(A &&f) {
+    if constexpr (inlined<F>) {
+      new (storage_.bytes) F(std::forward<A>(f));
+      return &Inline<F>::vtable;
+    } else {
+      new (storage_.bytes) Shared<F>(std::forward<A>(f));
+      return &Inline<Shared<F>>::vtable;
+    }
+  }
+
+  Engine::Step ToStep() const {
+    if (const Engine::Step *step = vtable_->step(storage_)) {
+      return *step;
+    }
+    return Engine::Leaf([eff = *this] { return Erased(eff()); });
+  }
+
+  Storage storage_;
+  const VTable *vtable_;
 
 public:
   template <typename F>
-  Effect(F &&f):
-    ptr_(std::make_unique<EffectImpl<F>>(std::forward<F>(f))) {}
-  
+    requires (!std::is_same_v<std::remove_cvref_t<F>, Effect> && !returning_void<F>)
+  Effect(F &&f): vtable_(Emplace<std::decay_t<F>>(std::forward<F>(f))) { }
+
   template <returning_void F>
-  Effect(F &&f):
-    ptr_(new EffectImpl([f = std::move(f)] () mutable { f(); return T(); })) {}
+  Effect(F &&f): vtable_(Emplace<Unit<std::decay_t<F>>>(Unit<std::decay_t<F>>{ std::forward<F>(f) })) { }
+
+  Effect(const Effect &eff): vtable_(eff.vtable_) { vtable_->copy(eff.storage_, storage_); }
+  Effect(Effect &&eff): vtable_(eff.vtable_) { vtable_->move(eff.storage_, storage_); }
+
+  Effect & operator = (const Effect &eff) {
+    return *this = Effect(eff);
+  }
+
+  Effect & operator = (Effect &&eff) {
+    if (this != &eff) {
+      vtable_->destroy(storage_);
+      vtable_ = eff.vtable_;
+      vtable_->move(eff.storage_, storage_);
+    }
+    return *this;
+  }
 
-  T operator () () const { return (*ptr_)(); }
+  ~Effect() { vtable_->destroy(storage_); }
+
+  T operator () () const { return vtable_->invoke(storage_); }
 
   static constexpr Effect Pure(const T &val) {
     return Effect([val = val] { return val; });
   }
 
+  static constexpr Effect Pure(T &&val) {
+    return Effect([val = std::move(val)] { return val; });
+  }
+
+  // Runs the unit effects in order.
+  static Effect Sequence(std::vector<Effect> effects) requires std::is_same_v<T, std::monostate> {
+    if (effects.size() == 1) {
+      return std::move(effects.front());
+    }
+    return Effect([effects = std::move(effects)] {
+      for (const Effect &eff : effects) {
+        eff();
+      }
+    });
+  }
+
   template <typename F, typename U>
   static constexpr Effect Bind(const Effect<U> &mVal, F &&f) {
-    return Effect([mVal = mVal, f = std::move(f)] { return f(mVal())(); });
+    return Effect(Bound(Engine::Bind(mVal.ToStep(), [f = std::forward<F>(f)](Erased &&val) {
+      return Effect(f(val.Take<U>())).ToStep();
+    })));
+  }
+
+  // Functor::Map, applied in place by the trampoline.
+  template <typename F, typename U>
+  static constexpr Effect Map(F &&f, const Effect<U> &mVal) {
+    return Effect(Bound(Engine::template Map<U, T>(mVal.ToStep(), std::forward<F>(f))));
   }
 };
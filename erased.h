@@ -0,0 +1,111 @@
+#pragma once
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// A type-erased value, like std::any but only movable so that move-only
+// values can be erased too. Small values movable without throwing are
+// stored inline, the others on the heap. Take<T>() must name the type
+// the value was made of.
+class Erased final
+{
+private:
+  struct Storage {
+    alignas(void *) std::byte bytes[4 * sizeof(void *)];
+  };
+
+  struct VTable {
+    void (*move)(Storage &, Storage &);
+    void (*destroy)(Storage &);
+  };
+
+  template <typename T>
+  struct Inline {
+    static T *Get(Storage &s) { return std::launder(reinterpret_cast<T *>(s.bytes)); }
+
+    static constexpr VTable vtable = {
+      [](Storage &src, Storage &dst) {
+        new (dst.bytes) T(std::move(*Get(src)));
+        Get(src)->~T();
+      },
+      [](Storage &s) { Get(s)->~T(); },
+    };
+  };
+
+  template <typename T>
+  struct Heap {
+    static T *&Get(Storage &s) { return *std::launder(reinterpret_cast<T **>(s.bytes)); }
+
+    static constexpr VTable vtable = {
+      [](Storage &src, Storage &dst) { new (dst.bytes) T *(Get(src)); },
+      [](Storage &s) { delete Get(s); },
+    };
+  };
+
+  template <typename T>
+  static constexpr bool inlined =
+    sizeof(T) <= sizeof(Storage) &&
+    alignof(T) <= alignof(Storage) &&
+    std::is_nothrow_move_constructible_v<T>;
+
+  Storage storage_;
+  const VTable *vtable_;
+
+public:
+  Erased(): vtable_(nullptr) { }
+
+  template <typename A>
+    requires (!std::is_same_v<std::remove_cvref_t<A>, Erased>)
+  Erased(A &&val) {
+    using T = std::decay_t<A>;
+    if constexpr (inlined<T>) {
+      new (storage_.bytes) T(std::forward<A>(val));
+      vtable_ = &Inline<T>::vtable;
+    } else {
+      new (storage_.bytes) T *(new T(std::forward<A>(val)));
+      vtable_ = &Heap<T>::vtable;
+    }
+  }
+
+  Erased(const Erased &) = delete;
+  Erased & operator = (const Erased &) = delete;
+
+  Erased(Erased &&val): vtable_(std::exchange(val.vtable_, nullptr)) {
+    if (vtable_ != nullptr) {
+      vtable_->move(val.storage_, storage_);
+    }
+  }
+
+  Erased & operator = (Erased &&val) {
+    if (this != &val) {
+      this->~Erased();
+      new (this) Erased(std::move(val));
+    }
+    return *this;
+  }
+
+  ~Erased() {
+    if (vtable_ != nullptr) {
+      vtable_->destroy(storage_);
+    }
+  }
+
+  bool HasValue() const { return vtable_ != nullptr; }
+
+  // Where `T` lives follows from the type, so no call through the vtable.
+  template <typename T>
+  T &Get() {
+    if constexpr (inlined<T>) {
+      return *Inline<T>::Get(storage_);
+    } else {
+      return *Heap<T>::Get(storage_);
+    }
+  }
+
+  // Moves the value out, this keeps the moved-from value.
+  template <typename T>
+  T Take() {
+    return std::move(Get<T>());
+  }
+};
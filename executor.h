@@ -0,0 +1,197 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <variant>
+#include <vector>
+
+#include "effect.h"
+
+// Where a piece of work runs.
+class IExecutor
+{
+public:
+  using Work = Effect<std::monostate>;
+
+  virtual ~IExecutor() = default;
+  virtual void Post(Work work) = 0;
+};
+
+// Runs the work right away on the calling thread.
+class InlineExecutor final: public IExecutor
+{
+public:
+  virtual void Post(Work work) override { work(); }
+};
+
+// A fixed number of threads, each owning a deque of work. A worker pops
+// its own deque from the back (the work it posted last is the hottest)
+// and steals from the front of the others when it runs dry. Work posted
+// from outside the pool is spread over the deques round-robin.
+//
+// The posted works are counted atomically, so posting only takes the
+// lock of a deque while the workers are busy. A worker with nothing to
+// claim sleeps on its own condition variable, the pool lock is only
+// taken to fall asleep and to wake one of the sleepers.
+//
+// The destructor finishes all the posted work before joining.
+class ThreadPool final: public IExecutor
+{
+public:
+  ThreadPool(std::size_t threads = std::max(1u, std::thread::hardware_concurrency())):
+    workers_(), threads_(), mutex_(), idle_(), sleeping_(0), pending_(0), stopping_(false), next_(0) {
+    idle_.reserve(threads);
+    for (std::size_t i = 0; i < threads; i++) {
+      workers_.push_back(std::make_unique<Worker>());
+    }
+    for (std::size_t i = 0; i < threads; i++) {
+      threads_.emplace_back([this, i]() { Run(i); });
+    }
+  }
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool & operator = (const ThreadPool &) = delete;
+
+  virtual ~ThreadPool() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stopping_ = true;
+      for (std::unique_ptr<Worker> &worker : workers_) {
+        worker->wake.notify_one();
+      }
+    }
+    for (std::thread &thread : threads_) {
+      thread.join();
+    }
+  }
+
+  std::size_t Size() const { return workers_.size(); }
+
+  virtual void Post(Work work) override {
+    std::size_t index = current_ == this ? index_ : next_++ % workers_.size();
+    {
+      std::lock_guard<std::mutex> lock(workers_[index]->mutex);
+      workers_[index]->deque.push_back(std::move(work));
+    }
+    // Either this sees the sleeper or the sleeper sees the work, both
+    // sides are sequentially consistent.
+    pending_.fetch_add(1);
+    if (sleeping_.load() > 0) {
+      Wake();
+    }
+  }
+
+private:
+  struct Worker
+  {
+    std::mutex mutex;
+    std::deque<Work> deque;
+    // Guarded by the pool lock.
+    std::condition_variable wake;
+    bool woken = false;
+  };
+
+  std::optional<Work> Pop(std::size_t self) {
+    {
+      Worker &worker = *workers_[self];
+      std::lock_guard<std::mutex> lock(worker.mutex);
+      if (!worker.deque.empty()) {
+        Work work = std::move(worker.deque.back());
+        worker.deque.pop_back();
+        return work;
+      }
+    }
+    for (std::size_t i = 1; i < workers_.size(); i++) {
+      Worker &victim = *workers_[(self + i) % workers_.size()];
+      std::lock_guard<std::mutex> lock(victim.mutex);
+      if (!victim.deque.empty()) {
+        Work work = std::move(victim.deque.front());
+        victim.deque.pop_front();
+        return work;
+      }
+    }
+    return std::nullopt;
+  }
+
+  // Claims one of the posted works, it is in one of the deques.
+  bool Claim() {
+    std::size_t pending = pending_.load();
+    while (pending > 0) {
+      if (pending_.compare_exchange_weak(pending, pending - 1)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Wakes the worker which fell asleep last, if any is still asleep.
+  void Wake() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (idle_.empty()) {
+      return;
+    }
+    Worker &worker = *workers_[idle_.back()];
+    idle_.pop_back();
+    sleeping_ -= 1;
+    worker.woken = true;
+    worker.wake.notify_one();
+  }
+
+  // Sleeps until there is work to claim, returns false once the pool is
+  // stopping and all the work is done.
+  bool Sleep(std::size_t self) {
+    Worker &worker = *workers_[self];
+    std::unique_lock<std::mutex> lock(mutex_);
+    idle_.push_back(self);
+    sleeping_ += 1;
+    if (pending_.load() == 0 && !stopping_) {
+      worker.wake.wait(lock, [this, &worker]() { return worker.woken || stopping_; });
+    }
+    if (worker.woken) {
+      worker.woken = false;
+    } else {
+      std::erase(idle_, self);
+      sleeping_ -= 1;
+    }
+    return !stopping_ || pending_.load() > 0;
+  }
+
+  void Run(std::size_t self) {
+    current_ = this;
+    index_ = self;
+    while (true) {
+      if (!Claim()) {
+        if (!Sleep(self)) {
+          return;
+        }
+        continue;
+      }
+      std::optional<Work> work = Pop(self);
+      while (!work.has_value()) {
+        std::this_thread::yield();
+        work = Pop(self);
+      }
+      work.value()();
+    }
+  }
+
+  std::vector<std::unique_ptr<Worker>> workers_;
+  std::vector<std::thread> threads_;
+  // Guards `idle_`, `stopping_` and the wakeups of the workers.
+  std::mutex mutex_;
+  // The sleeping workers, in the order they fell asleep.
+  std::vector<std::size_t> idle_;
+  std::atomic<std::size_t> sleeping_;
+  std::atomic<std::size_t> pending_;
+  bool stopping_;
+  std::atomic<std::size_t> next_;
+
+  static inline thread_local ThreadPool *current_ = nullptr;
+  static inline thread_local std::size_t index_ = 0;
+};
@@ -0,0 +1,55 @@
+#pragma once
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <list>
+#include <unordered_map>
+#include <utility>
+
+// Maps at most `capacity` keys to values, adding a key beyond that evicts
+// the least recently found or added one. Not thread-safe.
+template <typename K, typename V, typename Hash = std::hash<K>, typename Eq = std::equal_to<K>>
+class LruCache final
+{
+public:
+  LruCache(std::size_t capacity, const Hash &hash = Hash(), const Eq &eq = Eq()):
+    capacity_(capacity), entries_(), index_(capacity, hash, eq) { }
+
+  LruCache(const LruCache &) = delete;
+  LruCache & operator = (const LruCache &) = delete;
+
+  // The value of `key`, null if it isn't cached.
+  V *Find(const K &key) {
+    auto found = index_.find(key);
+    if (found == index_.end()) {
+      return nullptr;
+    }
+    entries_.splice(entries_.begin(), entries_, found->second);
+    return &found->second->second;
+  }
+
+  // Caches `value` for `key`, which mustn't be cached yet.
+  void Add(K key, V value) {
+    if (capacity_ == 0) {
+      return;
+    }
+    if (entries_.size() == capacity_) {
+      // Recycles the node of the evicted entry.
+      index_.erase(entries_.back().first);
+      entries_.splice(entries_.begin(), entries_, std::prev(entries_.end()));
+      entries_.front() = { std::move(key), std::move(value) };
+    } else {
+      entries_.emplace_front(std::move(key), std::move(value));
+    }
+    index_.emplace(entries_.front().first, entries_.begin());
+  }
+
+  std::size_t Size() const { return entries_.size(); }
+
+private:
+  using Entries = std::list<std::pair<K, V>>;
+
+  std::size_t capacity_;
+  Entries entries_;
+  std::unordered_map<K, typename Entries::iterator, Hash, Eq> index_;
+};
@@ -0,0 +1,172 @@
+#pragma once
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "./maybe.h"
+
+// A column of Maybe<T> stored as two arrays: the values, and a bitmap with
+// a set bit for each value present. The missing slots hold T(), whatever
+// the column was built from or whichever value was reset.
+//
+// Map and Lift apply the function to every slot, the missing ones too, in
+// loops without branches the compiler vectorizes, and only combine the
+// bitmaps word by word. The function must be defined on T() as well as on
+// the present values, in any mix of them for Lift: x + 1 on an int is,
+// 1 / x isn't. Bind calls its function on the present values only.
+template <typename T>
+class MaybeColumn final
+{
+public:
+  using Word = std::uint64_t;
+  static constexpr std::size_t bits = 64;
+
+  MaybeColumn(): values_(), validity_() { }
+
+  // `size` missing values.
+  explicit MaybeColumn(std::size_t size): values_(size), validity_(Words(size), 0) { }
+
+  // All of `values` present.
+  explicit MaybeColumn(std::vector<T> values): values_(std::move(values)), validity_(Words(values_.size()), ~Word(0)) {
+    ClearTail();
+  }
+
+  // `values` present where `validity` has their bit set, the others are
+  // replaced by T().
+  MaybeColumn(std::vector<T> values, std::vector<Word> validity): values_(std::move(values)), validity_(std::move(validity)) {
+    if (validity_.size() != Words(values_.size())) {
+      throw std::invalid_argument("MaybeColumn: the validity doesn't match the values");
+    }
+    ClearTail();
+    ClearMissing();
+  }
+
+  explicit MaybeColumn(const std::vector<Maybe<T>> &rows): MaybeColumn(rows.size()) {
+    for (std::size_t i = 0; i < rows.size(); i++) {
+      if (rows[i].HasValue()) {
+        Set(i, rows[i].Value());
+      }
+    }
+  }
+
+  std::size_t Size() const { return values_.size(); }
+
+  // The number of present values.
+  std::size_t Count() const {
+    std::size_t count = 0;
+    for (Word word : validity_) {
+      count += std::popcount(word);
+    }
+    return count;
+  }
+
+  bool HasValue(std::size_t i) const { return (validity_[i / bits] >> (i % bits)) & 1; }
+
+  Maybe<T> operator [] (std::size_t i) const { return HasValue(i) ? Maybe<T>(values_[i]) : Maybe<T>(); }
+
+  void Set(std::size_t i, T value) {
+    values_[i] = std::move(value);
+    validity_[i / bits] |= Word(1) << (i % bits);
+  }
+
+  void Reset(std::size_t i) {
+    values_[i] = T();
+    validity_[i / bits] &= ~(Word(1) << (i % bits));
+  }
+
+  const std::vector<T> &Values() const { return values_; }
+  const std::vector<Word> &Validity() const { return validity_; }
+
+  // Functor::Map
+  template <typename F>
+  MaybeColumn<std::invoke_result_t<F &, const T &>> Map(F &&f) const {
+    using U = std::invoke_result_t<F &, const T &>;
+    std::vector<U> values(Size());
+    for (std::size_t i = 0; i < values.size(); i++) {
+      values[i] = f(values_[i]);
+    }
+    return MaybeColumn<U>(std::move(values), std::vector<Word>(validity_));
+  }
+
+  // Functor::Map, in place when the type doesn't change.
+  template <typename F>
+    requires std::is_same_v<std::invoke_result_t<F &, const T &>, T>
+  MaybeColumn Map(F &&f) && {
+    for (std::size_t i = 0; i < values_.size(); i++) {
+      values_[i] = f(values_[i]);
+    }
+    ClearMissing();
+    return std::move(*this);
+  }
+
+  // Monad::Bind, `f` returns a Maybe.
+  template <typename F>
+  auto Bind(F &&f) const {
+    using U = std::remove_cvref_t<decltype(f(std::declval<const T &>()).Value())>;
+    MaybeColumn<U> column(Size());
+    for (std::size_t w = 0; w < validity_.size(); w++) {
+      for (Word present = validity_[w]; present != 0; present &= present - 1) {
+        std::size_t i = w * bits + std::countr_zero(present);
+        Maybe<U> val = f(values_[i]);
+        if (val.HasValue()) {
+          column.Set(i, std::move(val).Value());
+        }
+      }
+    }
+    return column;
+  }
+
+  static std::size_t Words(std::size_t size) { return (size + bits - 1) / bits; }
+
+private:
+  // The bits past the end are clear, so that the counts and the bitmaps
+  // combined are right.
+  void ClearTail() {
+    if (std::size_t rest = Size() % bits; rest != 0) {
+      validity_.back() &= (Word(1) << rest) - 1;
+    }
+  }
+
+  // The missing slots back to T(), after a function ran on them too.
+  void ClearMissing() {
+    for (std::size_t w = 0; w < validity_.size(); w++) {
+      Word missing = ~validity_[w];
+      if (w + 1 == validity_.size() && Size() % bits != 0) {
+        missing &= (Word(1) << (Size() % bits)) - 1;
+      }
+      for (; missing != 0; missing &= missing - 1) {
+        values_[w * bits + std::countr_zero(missing)] = T();
+      }
+    }
+  }
+
+  std::vector<T> values_;
+  std::vector<Word> validity_;
+};
+
+// Applicative, `f` of the values of the same rows of the columns, present
+// where all of them are.
+template <typename F, typename U, typename... Us>
+MaybeColumn<std::invoke_result_t<F &, const U &, const Us &...>> Lift(F &&f, const MaybeColumn<U> &column, const MaybeColumn<Us> &... columns) {
+  using R = std::invoke_result_t<F &, const U &, const Us &...>;
+  using Word = typename MaybeColumn<R>::Word;
+  std::size_t size = column.Size();
+  if (((columns.Size() != size) || ...)) {
+    throw std::invalid_argument("Lift: the columns differ in size");
+  }
+
+  std::vector<R> values(size);
+  for (std::size_t i = 0; i < size; i++) {
+    values[i] = f(column.Values()[i], columns.Values()[i]...);
+  }
+
+  std::vector<Word> validity(column.Validity());
+  for (std::size_t w = 0; w < validity.size(); w++) {
+    validity[w] = (validity[w] & ... & columns.Validity()[w]);
+  }
+  return MaybeColumn<R>(std::move(values), std::move(validity));
+}
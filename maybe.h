@@ -1,29 +1,52 @@
 #pragma once
 #include <optional>
+#include <type_traits>
+#include <utility>
+
+#include "./niche.h"
 
 template <typename T>
 class Maybe
 {
 private:
-  Maybe(const std::optional<T> &opt): opt_(opt) { }
+  template <typename> friend class Maybe;
+
+  // A type with a spare representation stores no flag, see MaybeNiche.
+  using Storage = std::conditional_t<has_niche<T>, NicheOptional<T>, std::optional<T>>;
+
+  constexpr Maybe(Storage &&opt): opt_(std::move(opt)) { }
 public:
-  Maybe(): Maybe(std::nullopt) { }
+  constexpr Maybe(): opt_(std::nullopt) { }
   // Monad::Pure
-  Maybe(const T &val): Maybe(std::optional(val)) { }
+  constexpr Maybe(const T &val): opt_(val) { }
+  constexpr Maybe(T &&val): opt_(std::move(val)) { }
   // Functor::Map
   template <typename F, typename U>
-  Maybe(const F f, const Maybe<U> &val): Maybe(val.HasValue() ? std::optional(f(val.Value())) : std::nullopt) { }
+  constexpr Maybe(const F f, const Maybe<U> &val): Maybe(val.HasValue() ? Storage(f(val.Value())) : Storage(std::nullopt)) { }
+  template <typename F, typename U>
+  constexpr Maybe(const F f, Maybe<U> &&val): Maybe(val.HasValue() ? Storage(f(std::move(val).Value())) : Storage(std::nullopt)) { }
   // Monad::Join
-  Maybe(const Maybe<Maybe<T>> &mmVal): Maybe(mmVal.HasValue() ? mmVal.Value().opt_ : std::nullopt) { }
+  constexpr Maybe(const Maybe<Maybe<T>> &mmVal): opt_(mmVal.HasValue() ? mmVal.Value().opt_ : Storage(std::nullopt)) { }
+  constexpr Maybe(Maybe<Maybe<T>> &&mmVal): opt_(mmVal.HasValue() ? std::move(mmVal.opt_.value().opt_) : Storage(std::nullopt)) { }
+
+  // Applicative, `f` of all the values if none is missing.
+  template <typename F, typename... Us>
+  static constexpr Maybe Combine(F &&f, const Maybe<Us> &... mVals) {
+    if ((mVals.HasValue() && ...)) {
+      return Maybe(std::forward<F>(f)(mVals.Value()...));
+    }
+    return Maybe();
+  }
 
-  const T &Value() const { return opt_.value(); }
+  constexpr const T &Value() const & { return opt_.value(); }
+  constexpr T &&Value() && { return std::move(opt_.value()); }
 
-  bool HasValue() const { return opt_.has_value(); }
+  constexpr bool HasValue() const { return opt_.has_value(); }
 
-  bool operator == (const Maybe &mVal) const { return opt_ == mVal.opt_; }
+  constexpr bool operator == (const Maybe &mVal) const { return opt_ == mVal.opt_; }
 
-  explicit operator bool () const { return opt_.has_value(); }
+  constexpr explicit operator bool () const { return opt_.has_value(); }
 
 private:
-  std::optional<T> opt_;
+  Storage opt_;
 };
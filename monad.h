@@ -1,48 +1,106 @@
 #pragma once
-#include <functional>
+#include <cstddef>
+#include <memory>
+#include <tuple>
 #include <type_traits>
 #include <concepts>
 #include <utility>
 
-template <typename R, typename Arg, typename... Args>
-std::function<R(Args...)> BindFn(std::function<R(Arg, Args...)> f, const Arg &arg) {
-  return std::function([=](Args... args) { return f(arg, args...); });
-}
-
 template <template <typename> typename M>
 struct Monad {
   template <typename T>
-  static M<T> Pure(const T &val) {
-    return M<T>(val);
+  static constexpr M<std::decay_t<T>> Pure(T &&val) {
+    return M<std::decay_t<T>>(std::forward<T>(val));
   }
 
   template <typename F, typename T>
-  static M<std::invoke_result_t<F, T>> Map(const F &f, const M<T> &mVal) {
+  static constexpr M<std::invoke_result_t<F, T>> Map(const F &f, const M<T> &mVal) {
     using ResultType = M<std::invoke_result_t<F, T>>;
     return ResultType(f, mVal);
   }
 
   template <typename F, typename T>
-  static std::invoke_result_t<F, T> Bind(const M<T> &mVal, const F &f) {
+  static constexpr M<std::invoke_result_t<F, T>> Map(const F &f, M<T> &&mVal) {
+    using ResultType = M<std::invoke_result_t<F, T>>;
+    return ResultType(f, std::move(mVal));
+  }
+
+  template <typename F, typename T>
+  static constexpr std::invoke_result_t<F, T> Bind(const M<T> &mVal, const F &f) {
     using ResultType = std::invoke_result_t<F, T>;
     return ResultType(M<ResultType>(f, mVal));
   }
 
+  template <typename F, typename T>
+  static constexpr std::invoke_result_t<F, T> Bind(M<T> &&mVal, const F &f) {
+    using ResultType = std::invoke_result_t<F, T>;
+    return ResultType(M<ResultType>(f, std::move(mVal)));
+  }
+
   template <typename T>
-  static M<T> Join(const M<M<T>> &mmVal) {
+  static constexpr M<T> Join(const M<M<T>> &mmVal) {
     return M<T>(mmVal);
   }
 
+  template <typename T>
+  static constexpr M<T> Join(M<M<T>> &&mmVal) {
+    return M<T>(std::move(mmVal));
+  }
+
   template <typename F, typename V>
-  static M<std::invoke_result_t<F, V>> Lift(const F &f, const M<V> &mVal) {
+  static constexpr M<std::invoke_result_t<F, V>> Lift(const F &f, const M<V> &mVal) {
     return Monad<M>::Map(f, mVal);
   }
 
-  template <typename F, typename V, typename... Args>
-  static auto Lift(const F &f, const M<V> &mVal, Args... args) {
-    return Bind(mVal, [=](const V &v) {
-      return Lift(BindFn(std::function(f), v), args...);
-    });
+  // The function and the remaining monadic values are moved once into a
+  // shared tuple. Each stage binds one more value and links it in front of
+  // the values bound so far, which are shared rather than copied, so each
+  // value is copied once however many follow it.
+  //
+  // A monad with an applicative Combine of independent values combines
+  // them instead.
+  template <typename F, typename V, typename... Vs>
+  static constexpr auto Lift(F &&f, const M<V> &mVal, M<Vs>... mVals) {
+    using R = std::invoke_result_t<F, V, Vs...>;
+    if constexpr (requires { M<R>::Combine(std::forward<F>(f), mVal, mVals...); }) {
+      return M<R>::Combine(std::forward<F>(f), mVal, mVals...);
+    } else {
+      auto lifted = std::make_shared<const std::tuple<std::decay_t<F>, M<Vs>...>>(std::forward<F>(f), std::move(mVals)...);
+      return LiftFrom<1>(lifted, mVal, nullptr);
+    }
+  }
+
+private:
+  // A value bound by a Lift, linked to the ones bound before it (or null
+  // for the first one).
+  template <typename W, typename Prev>
+  struct Bound {
+    W value;
+    Prev prev;
+  };
+
+  template <std::size_t I, typename Lifted, typename W, typename Prev>
+  static auto LiftFrom(const std::shared_ptr<Lifted> &lifted, const M<W> &mVal, Prev &&bound) {
+    if constexpr (I == std::tuple_size_v<Lifted>) {
+      return Map([lifted, bound = std::move(bound)](const W &w) {
+        return Call(std::get<0>(*lifted), bound, w);
+      }, mVal);
+    } else {
+      return Bind(mVal, [lifted, bound = std::move(bound)](const W &w) {
+        return LiftFrom<I + 1>(lifted, std::get<I>(*lifted), std::make_shared<const Bound<W, Prev>>(Bound<W, Prev> { w, bound }));
+      });
+    }
+  }
+
+  // Calls `f` with the values bound so far, the first one first.
+  template <typename F, typename... Ws>
+  static decltype(auto) Call(const F &f, std::nullptr_t, const Ws &... values) {
+    return f(values...);
+  }
+
+  template <typename F, typename W, typename Prev, typename... Ws>
+  static decltype(auto) Call(const F &f, const std::shared_ptr<const Bound<W, Prev>> &bound, const Ws &... values) {
+    return Call(f, bound->prev, bound->value, values...);
   }
 };
 
@@ -50,11 +108,11 @@ template <template <typename> typename M, typename T>
 concept monad = std::is_base_of_v<decltype(M(std::declval<T>())), T>;
 
 template <template <typename> typename M, typename T, typename F>
-std::invoke_result_t<F, T> operator >> (const M<T> &val, const F &f) requires monad<M, std::invoke_result_t<F, T>> {
+constexpr std::invoke_result_t<F, T> operator >> (const M<T> &val, const F &f) requires monad<M, std::invoke_result_t<F, T>> {
   return Monad<M>::Bind(val, f);
 }
 
 template <template <typename> typename M, typename T, typename F>
-M<std::invoke_result_t<F, T>> operator >> (const M<T> &val, const F &f) {
+constexpr M<std::invoke_result_t<F, T>> operator >> (const M<T> &val, const F &f) {
   return Monad<M>::Map(f, val);
 }
\ No newline at end of file
@@ -0,0 +1,107 @@
+#pragma once
+#include <bit>
+#include <concepts>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+// A spare representation of T, which a Maybe<T> stores as its missing
+// value instead of a separate flag, so that it is no bigger than T.
+//
+// A specialization provides `Empty()`, the spare representation, and
+// `IsEmpty(val)`. The floating point types spare a signaling NaN payload
+// no arithmetic produces. Other types opt in when they really never take
+// that value, e.g. indices which never reach the maximum, or pointers to
+// aligned objects:
+//
+//   template <> struct MaybeNiche<Index>: SentinelNiche<Index, Index(-1)> { };
+//   template <> struct MaybeNiche<Node *>: AlignedPointerNiche<Node> { };
+//
+// The specialization must be visible wherever Maybe<Index> is used, or
+// its layout differs between translation units. Making a Maybe of the
+// spare representation throws std::invalid_argument.
+template <typename T>
+struct MaybeNiche { };
+
+template <typename T>
+concept has_niche = requires (const T &val) {
+  { MaybeNiche<T>::Empty() } -> std::same_as<T>;
+  { MaybeNiche<T>::IsEmpty(val) } -> std::same_as<bool>;
+};
+
+template <typename T, T sentinel>
+struct SentinelNiche
+{
+  static constexpr T Empty() { return sentinel; }
+  static constexpr bool IsEmpty(const T &val) { return val == sentinel; }
+};
+
+// A misaligned address. Only for complete types, whose alignment is
+// known where the specialization is declared. Not usable in constant
+// expressions, the address is made up.
+template <typename T>
+struct AlignedPointerNiche
+{
+  static_assert(sizeof(T) > 0, "AlignedPointerNiche: T must be complete");
+  static_assert(alignof(T) > 1, "AlignedPointerNiche: T must be aligned on more than one byte");
+
+  static constexpr std::uintptr_t address = alignof(T) - 1;
+
+  static T *Empty() { return reinterpret_cast<T *>(address); }
+  static bool IsEmpty(T *const &val) { return reinterpret_cast<std::uintptr_t>(val) == address; }
+};
+
+// A signaling NaN, quieted by any arithmetic.
+template <typename T>
+  requires std::floating_point<T> && std::numeric_limits<T>::is_iec559 && (sizeof(T) == 4 || sizeof(T) == 8)
+struct MaybeNiche<T>
+{
+  using Bits = std::conditional_t<sizeof(T) == 4, std::uint32_t, std::uint64_t>;
+  static constexpr Bits bits = sizeof(T) == 4 ? Bits(0x7f80dead) : Bits(0x7ff000000000deadull);
+
+  static constexpr T Empty() { return std::bit_cast<T>(bits); }
+  static constexpr bool IsEmpty(const T &val) { return std::bit_cast<Bits>(val) == bits; }
+};
+
+// The subset of std::optional that Maybe uses, storing the missing value
+// as the spare representation of T.
+template <typename T>
+class NicheOptional final
+{
+public:
+  constexpr NicheOptional(std::nullopt_t): value_(MaybeNiche<T>::Empty()) { }
+  constexpr NicheOptional(const T &value): value_(Valid(value)) { }
+  constexpr NicheOptional(T &&value): value_(std::move(Valid(value))) { }
+
+  constexpr bool has_value() const { return !MaybeNiche<T>::IsEmpty(value_); }
+
+  constexpr const T &value() const & { return Checked(value_); }
+  constexpr T &value() & { return Checked(value_); }
+  constexpr T &&value() && { return std::move(Checked(value_)); }
+
+  constexpr bool operator == (const NicheOptional &opt) const {
+    return has_value() && opt.has_value() ? value_ == opt.value_ : has_value() == opt.has_value();
+  }
+
+private:
+  template <typename V>
+  static constexpr V &Valid(V &value) {
+    if (MaybeNiche<T>::IsEmpty(value)) {
+      throw std::invalid_argument("Maybe: the value is the spare representation of its type");
+    }
+    return value;
+  }
+
+  template <typename V>
+  constexpr V &Checked(V &value) const {
+    if (!has_value()) {
+      throw std::bad_optional_access();
+    }
+    return value;
+  }
+
+  T value_;
+};
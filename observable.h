@@ -1,9 +1,19 @@
 #pragma once
+#include <array>
+#include <cstddef>
 #include <utility>
 #include <functional>
 #include <memory>
+#include <optional>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
 
 #include "./chain.h"
+#include "./change-detection.h"
+#include "./pool-allocator.h"
+#include "./propagation.h"
+#include "./scheduler.h"
 
 template <typename T> class Observable;
 
@@ -12,57 +22,172 @@ class Observable final
 {
 public:
   using Observer = std::function<void(const T &, const T &)>;
+  // The nodes of the observers are recycled by their subject, so observing
+  // and unobserving don't allocate once warmed up.
+  using Observers = Chain<Observer, FreeListAllocator<Observer>>;
 
-  class Subject
+  class Subject: public Propagation::Node
   {
   public:
-    Subject(const T &value): value_(value), obs_() {}
+    Subject(const T &value): value_(value), nodes_(), obs_(nodes_), pending_(std::nullopt), modified_(false), version_(0) {}
+    Subject(T &&value): value_(std::move(value)), nodes_(), obs_(nodes_), pending_(std::nullopt), modified_(false), version_(0) {}
 
-    Subject(const Subject &) = delete;
-    Subject & operator = (const Subject &) = delete;
+    template <typename F>
+    typename Observers::Deleter Observe(const F &ob) {
+      return obs_.Add(Observer(ob));
+    }
 
-    Subject(Subject &&) = default;
-    Subject & operator = (Subject &&) = default;
+    void Observe(typename Observers::Hook &hook) {
+      obs_.Link(hook);
+    }
 
-    template <typename F>
-    typename Chain<Observer>::Deleter Observe(const F &ob) {
-      return obs_.Add(std::function(ob));
+    const T &Value() {
+      Pull();
+      return value_;
+    }
+
+    // Counts the changes of the value.
+    std::size_t Version() {
+      Pull();
+      return version_;
+    }
+
+    void Notify(const T &value) { Assign(value); }
+    void Notify(T &&value) { Assign(std::move(value)); }
+
+    // Stages `value` to be notified by the next flush, the latest value
+    // wins when updated several times in a batch.
+    void Update(const T &value) {
+      pending_ = value;
+      Propagation::Schedule(*this);
+    }
+
+    void Update(T &&value) {
+      pending_ = std::move(value);
+      Propagation::Schedule(*this);
     }
 
-    const T &Value() const { return value_; }
+    // Mutates the value in place, `f` may return false when it didn't
+    // change anything. The old value is gone, so the observers get the
+    // new value as both arguments. Applies to the staged value if any.
+    template <typename F>
+    void Modify(F &&f) {
+      T &value = pending_.has_value() ? pending_.value() : value_;
+      if constexpr (std::is_same_v<std::invoke_result_t<F, T &>, bool>) {
+        if (!f(value)) {
+          return;
+        }
+      } else {
+        f(value);
+      }
+      modified_ = modified_ || !pending_.has_value();
+      Propagation::Schedule(*this);
+    }
 
-    void Notify(const T &value) {
-      if (value != value_) {
-        obs_.ForEach([this, &value](const Observer &ob) { ob(value, value_); });
-        value_ = value;
+  protected:
+    virtual void Recompute() override {
+      bool modified = std::exchange(modified_, false);
+      if (pending_.has_value()) {
+        T value = std::move(pending_.value());
+        pending_ = std::nullopt;
+        if (Assign(std::move(value))) {
+          return;
+        }
+      }
+      if (modified) {
+        obs_.ForEach([this](const Observer &ob) { ob(value_, value_); });
+        Changed();
       }
     }
 
+    // Brings the value up to date before it is read.
+    virtual void Pull() { }
+
   private:
+    template <typename V>
+    bool Assign(V &&value) {
+      if (!ChangeDetection<T>::Changed(value_, value)) {
+        return false;
+      }
+      obs_.ForEach([this, &value](const Observer &ob) { ob(value, value_); });
+      value_ = std::forward<V>(value);
+      Changed();
+      return true;
+    }
+
+    void Changed() {
+      version_ += 1;
+      Propagation::Advance();
+      this->ScheduleDependents();
+    }
+
     T value_;
-    Chain<Observer> obs_;
+    FreeList nodes_;
+    Observers obs_;
+    std::optional<T> pending_;
+    bool modified_;
+    std::size_t version_;
   };
 
   class Unobserve
   {
   public:
-    Unobserve(std::shared_ptr<Subject> subject, Chain<Observer>::Deleter &&deleter)
-      : subject_(subject), deleter_(std::move(deleter)) { }
+    Unobserve(std::shared_ptr<Subject> subject, Propagation::Node::Demand &&demand, Observers::Deleter &&deleter)
+      : subject_(subject), demand_(std::move(demand)), deleter_(std::move(deleter)) { }
 
     Unobserve(const Unobserve &) = delete;
     Unobserve& operator = (const Unobserve &) = delete;
 
     Unobserve(Unobserve &&) = default;
-    Unobserve& operator = (Unobserve &&unob) = default;
+
+    // Drops the observer before the subject it points into.
+    Unobserve& operator = (Unobserve &&unob) {
+      deleter_ = std::move(unob.deleter_);
+      demand_ = std::move(unob.demand_);
+      subject_ = std::move(unob.subject_);
+      return *this;
+    }
 
     Observable<T> operator () () {
       deleter_();
+      demand_();
       return Observable<T>(std::move(subject_));
     }
     
   private:
     std::shared_ptr<Subject> subject_;
-    Chain<Observer>::Deleter deleter_;
+    Propagation::Node::Demand demand_;
+    Observers::Deleter deleter_;
+  };
+
+  // An observer its owner embeds, e.g. as a member of a widget, so that
+  // observing and unobserving don't allocate: a callable small enough for
+  // std::function to store inline, like a lambda capturing `this`, costs
+  // no allocation at all. The observable must outlive the subscription.
+  class Hook final
+  {
+  public:
+    template <typename F>
+      requires (!std::is_same_v<std::remove_cvref_t<F>, Hook>)
+    Hook(F &&f): link_(Observer(std::forward<F>(f))), demand_() { }
+
+    Hook(const Hook &) = delete;
+    Hook & operator = (const Hook &) = delete;
+
+    ~Hook() { Unobserve(); }
+
+    void Unobserve() {
+      link_.Unlink();
+      demand_();
+    }
+
+    bool Observing() const { return link_.Linked(); }
+
+  private:
+    friend class Observable;
+
+    typename Observers::Hook link_;
+    Propagation::Node::Demand demand_;
   };
 
   template <typename U>
@@ -72,11 +197,109 @@ public:
     template <typename F>
     MapSubject(Observable<U> ob, const F &func):
       Subject(func(ob.Value())),
-      unob_(ob.Observe([this, func = func](const U &val, const U &valOld) {
-        this->Notify(func(val));
-      })) { }
+      ob_(ob),
+      func_(func),
+      dep_(this->DependOn(*ob_.subject_)) { }
+
+  protected:
+    virtual void Recompute() override {
+      this->Notify(func_(ob_.Value()));
+    }
+
+  private:
+    Observable<U> ob_;
+    std::function<T(const U &)> func_;
+    Propagation::Node::Dependency dep_;
+  };
+
+  // Depends on each of its inputs once and recomputes in place when any
+  // of them changes, the graph never changes.
+  template <typename F, typename... Us>
+  class CombineSubject: public Subject
+  {
+  public:
+    template <typename A>
+    CombineSubject(A &&func, const Observable<Us> &... obs):
+      Subject(func(obs.Value()...)),
+      obs_(obs...),
+      func_(std::forward<A>(func)),
+      deps_(DependOnAll(std::index_sequence_for<Us...>{})) { }
+
+  protected:
+    virtual void Recompute() override {
+      this->Notify(std::apply([this](const Observable<Us> &... obs) { return func_(obs.Value()...); }, obs_));
+    }
+
   private:
-    typename Observable<U>::Unobserve unob_;
+    template <std::size_t... Is>
+    std::array<Propagation::Node::Dependency, sizeof...(Us)> DependOnAll(std::index_sequence<Is...>) {
+      return { this->DependOn(*std::get<Is>(obs_).subject_)... };
+    }
+
+    std::tuple<Observable<Us>...> obs_;
+    F func_;
+    std::array<Propagation::Node::Dependency, sizeof...(Us)> deps_;
+  };
+
+  // Like CombineSubject, but only hooked onto its inputs while in demand.
+  // Otherwise changes of the inputs cost it nothing, and it recomputes when
+  // read if any of them changed since.
+  template <typename F, typename... Us>
+  class LazySubject: public Subject
+  {
+  public:
+    template <typename A>
+    LazySubject(A &&func, const Observable<Us> &... obs):
+      Subject(func(obs.Value()...)),
+      obs_(obs...),
+      func_(std::forward<A>(func)),
+      versions_(Versions(std::index_sequence_for<Us...>{})),
+      checked_(Propagation::Epoch()),
+      deps_(std::nullopt) { }
+
+  protected:
+    virtual void Recompute() override {
+      versions_ = Versions(std::index_sequence_for<Us...>{});
+      this->Notify(std::apply([this](const Observable<Us> &... obs) { return func_(obs.Value()...); }, obs_));
+    }
+
+    virtual void Pull() override {
+      if (deps_.has_value() || checked_ == Propagation::Epoch()) {
+        return;
+      }
+      checked_ = Propagation::Epoch();
+      if (Versions(std::index_sequence_for<Us...>{}) != versions_) {
+        Recompute();
+        checked_ = Propagation::Epoch();
+      }
+    }
+
+    virtual void Attach() override {
+      Pull();
+      deps_.emplace(DependOnAll(std::index_sequence_for<Us...>{}));
+    }
+
+    virtual void Detach() override {
+      deps_ = std::nullopt;
+      Propagation::Cancel(*this);
+    }
+
+  private:
+    template <std::size_t... Is>
+    std::array<std::size_t, sizeof...(Us)> Versions(std::index_sequence<Is...>) const {
+      return { std::get<Is>(obs_).subject_->Version()... };
+    }
+
+    template <std::size_t... Is>
+    std::array<Propagation::Node::Dependency, sizeof...(Us)> DependOnAll(std::index_sequence<Is...>) {
+      return { this->DependOn(*std::get<Is>(obs_).subject_)... };
+    }
+
+    std::tuple<Observable<Us>...> obs_;
+    F func_;
+    std::array<std::size_t, sizeof...(Us)> versions_;
+    std::size_t checked_;
+    std::optional<std::array<Propagation::Node::Dependency, sizeof...(Us)>> deps_;
   };
 
   class JoinSubject: public Subject
@@ -84,31 +307,166 @@ public:
   public:
     JoinSubject(Observable<Observable<T>> ob):
       Subject(ob.Value().Value()),
-      unobInner_(ob.Value().Observe([this](const T &valNew, const T &valOld) {
-        this->Notify(valNew);
-      })),
-      unobOutter_(ob.Observe([this](const Observable<T> &obNew, const Observable<T> &obOld) {
-        this->unobInner_ = std::move(obNew.Observe([this](const T &valNew, const T &valOld) {
-          this->Notify(valNew);
-        }));
-        this->Notify(obNew.Value());
-      })) { }
+      outer_(ob),
+      inner_(ob.Value()),
+      depOuter_(this->DependOn(*outer_.subject_)),
+      depInner_(this->DependOn(*inner_.subject_)) { }
+
+  protected:
+    virtual void Recompute() override {
+      if (!(inner_ == outer_.Value())) {
+        std::size_t height = this->Height();
+        // The old inner observable is kept until its edge is dropped.
+        depInner_ = this->DependOn(*outer_.Value().subject_);
+        inner_ = outer_.Value();
+        // The new inner observable may still be dirty, wait for it.
+        if (this->Height() != height) {
+          Propagation::Schedule(*this);
+          return;
+        }
+      }
+      this->Notify(inner_.Value());
+    }
+
+  private:
+    Observable<Observable<T>> outer_;
+    Observable<T> inner_;
+    Propagation::Node::Dependency depOuter_;
+    Propagation::Node::Dependency depInner_;
+  };
+
+  // How a paced observable follows the changes of its input.
+  enum class Pace {
+    // Once per turn of the scheduler.
+    Coalesce,
+    // At the end of each interval since creation.
+    Sample,
+    // Right away, then at most once per interval.
+    Throttle,
+    // Once the input stayed unchanged for an interval.
+    Debounce,
+  };
+
+  // Follows its input at a pace, holding back its changes until the time
+  // set by the scheduler comes. Only the latest value is propagated.
+  class PacedSubject: public Subject, public std::enable_shared_from_this<PacedSubject>
+  {
+  public:
+    using TimePoint = IScheduler::Clock::time_point;
+    using Duration = IScheduler::Clock::duration;
+
+    PacedSubject(Observable<T> ob, Pace pace, Duration interval, IScheduler &scheduler):
+      Subject(ob.Value()),
+      ob_(ob),
+      pace_(pace),
+      interval_(interval),
+      scheduler_(scheduler),
+      origin_(scheduler.Now()),
+      open_(origin_),
+      quiet_(origin_),
+      seen_(ob_.subject_->Version()),
+      waiting_(false),
+      due_(false),
+      dep_(this->DependOn(*ob_.subject_)) { }
+
+  protected:
+    virtual void Recompute() override {
+      TimePoint now = scheduler_.Now();
+      if (std::size_t version = ob_.subject_->Version(); version != seen_) {
+        seen_ = version;
+        Changed(now);
+      }
+      if (std::exchange(due_, false)) {
+        Due(now);
+      }
+    }
 
   private:
-    typename Observable<T>::Unobserve unobInner_;
-    typename Observable<Observable<T>>::Unobserve unobOutter_;
+    void Changed(TimePoint now) {
+      switch (pace_) {
+        case Pace::Coalesce:
+          Wait(now);
+          break;
+        case Pace::Sample:
+          Wait(origin_ + ((now - origin_) / interval_ + 1) * interval_);
+          break;
+        case Pace::Throttle:
+          if (!waiting_ && now >= open_) {
+            open_ = now + interval_;
+            this->Notify(ob_.Value());
+          } else {
+            Wait(open_);
+          }
+          break;
+        case Pace::Debounce:
+          quiet_ = now + interval_;
+          Wait(quiet_);
+          break;
+      }
+    }
+
+    void Due(TimePoint now) {
+      if (pace_ == Pace::Debounce && now < quiet_) {
+        Wait(quiet_);
+        return;
+      }
+      open_ = now + interval_;
+      this->Notify(ob_.Value());
+    }
+
+    // One timer at a time, a change coming while waiting rides on it.
+    void Wait(TimePoint at) {
+      if (waiting_) {
+        return;
+      }
+      waiting_ = true;
+      scheduler_.PostAt(at, [weak = this->weak_from_this()]() {
+        if (std::shared_ptr<PacedSubject> self = weak.lock()) {
+          self->waiting_ = false;
+          self->due_ = true;
+          Propagation::Schedule(*self);
+          Propagation::Flush();
+        }
+      });
+    }
+
+    Observable<T> ob_;
+    Pace pace_;
+    Duration interval_;
+    IScheduler &scheduler_;
+    TimePoint origin_;
+    TimePoint open_;
+    TimePoint quiet_;
+    std::size_t seen_;
+    bool waiting_;
+    bool due_;
+    Propagation::Node::Dependency dep_;
   };
 
   class Updater
   {
   public:
     Updater(std::shared_ptr<Subject> subject): subject_(subject) { }
-    void operator () (const T &val) const { subject_->Notify(val); }
+    void operator () (const T &val) const {
+      subject_->Update(val);
+      Propagation::Flush();
+    }
+    void operator () (T &&val) const {
+      subject_->Update(std::move(val));
+      Propagation::Flush();
+    }
+    template <typename F>
+    void Modify(F &&f) const {
+      subject_->Modify(std::forward<F>(f));
+      Propagation::Flush();
+    }
   private:
     std::shared_ptr<Subject> subject_;
   };
 
 private:
+  template <typename> friend class Observable;
+
   Observable(std::shared_ptr<Subject> subject) : subject_(subject) {}
 
 public:
@@ -118,17 +476,50 @@ public:
   Observable(const F &f, const Observable<U> &val): Observable(std::make_shared<MapSubject<U>>(val, f)) { }
   // Monad::Pure
   Observable(const T &value): Observable(std::make_shared<Subject>(value)) { }
+  Observable(T &&value): Observable(std::make_shared<Subject>(std::move(value))) { }
   // Monad::Join
   Observable(Observable<Observable<T>> ob) : Observable(std::make_shared<JoinSubject>(ob)) { }
 
+  // Applicative, `f` of the current values of all of `obs`.
+  template <typename F, typename... Us>
+  static Observable Combine(F &&f, const Observable<Us> &... obs) {
+    return Observable(std::make_shared<CombineSubject<std::decay_t<F>, Us...>>(std::forward<F>(f), obs...));
+  }
+
+  // `ob` at a pace, timed by `scheduler` which must outlive it. The
+  // interval must be positive, except for Coalesce which has none.
+  static Observable Paced(const Observable &ob, Pace pace, IScheduler::Clock::duration interval, IScheduler &scheduler) {
+    if (pace != Pace::Coalesce && interval <= IScheduler::Clock::duration::zero()) {
+      throw std::invalid_argument("Paced: the interval must be positive");
+    }
+    return Observable(std::make_shared<PacedSubject>(ob, pace, interval, scheduler));
+  }
+
+  // Like Combine, but only recomputed while observed or when read.
+  template <typename F, typename... Us>
+  static Observable Lazy(F &&f, const Observable<Us> &... obs) {
+    return Observable(std::make_shared<LazySubject<std::decay_t<F>, Us...>>(std::forward<F>(f), obs...));
+  }
+
   // Comparable
   bool operator == (const Observable<T> &ob) const {
     return subject_ == ob.subject_;
   }
 
+  // The observed value is brought up to date first, so catching up
+  // doesn't notify `f`. `f` may unobserve itself when notified, its
+  // captures are then gone, it must not touch them any more.
   template <typename F>
   Unobserve Observe(const F &f) const {
-    return Unobserve(subject_, subject_->Observe(f));
+    Propagation::Node::Demand demand(*subject_);
+    return Unobserve(subject_, std::move(demand), subject_->Observe(f));
+  }
+
+  // Observes with `hook`, which stops observing what it observed before.
+  void Observe(Hook &hook) const {
+    hook.Unobserve();
+    hook.demand_ = Propagation::Node::Demand(*subject_);
+    subject_->Observe(hook.link_);
   }
 
   const T &Value() const {
@@ -143,6 +534,11 @@ public:
     auto subject = std::make_shared<Subject>(value);
     return std::make_pair(Observable<T>(subject), Updater(subject));
   }
+
+  static std::pair<Observable<T>, Updater> Mutable(T &&value) {
+    auto subject = std::make_shared<Subject>(std::move(value));
+    return std::make_pair(Observable<T>(subject), Updater(subject));
+  }
 };
 
 template <typename T>
@@ -150,21 +546,15 @@ class TransactionalUpdater
 {
 public:
   using Unobserve = Observable<T>::Unobserve;
-  using Updater = Observable<T>::Updater;
 public:
-  TransactionalUpdater(Unobserve &&unob, Updater update):
-    unob_(std::move(unob)), update_(update) { }
+  TransactionalUpdater(Unobserve &&unob): unob_(std::move(unob)) { }
 
   template <typename F>
   void operator () (F &&f) {
-    Observable<T> ob = unob_();
-    f();
-    unob_ = ob.Observe([this](const T &valNew, const T &) { this->update_(valNew); });
-    update_(ob.Value());
+    Propagation::Batch(std::forward<F>(f));
   }
 
 private:
-  Updater update_;
   Unobserve unob_;
 };
 
@@ -172,6 +562,36 @@ template <typename T>
 std::pair<Observable<T>, TransactionalUpdater<T>> Transactional(Observable<T> ob) {
   auto [obT, updateT] = Observable<T>::Mutable(ob.Value());
   return std::make_pair(obT, TransactionalUpdater<T>(
-    ob.Observe([=](const T &valNew, const T &) { updateT(valNew); }),
-    updateT));
+    ob.Observe([=](const T &valNew, const T &) { updateT(valNew); })));
+}
+
+// Applicative lift of `f`, recomputed in place when any of `obs` changes.
+template <typename F, typename... Us>
+Observable<std::invoke_result_t<F &, const Us &...>> Combine(F &&f, const Observable<Us> &... obs) {
+  return Observable<std::invoke_result_t<F &, const Us &...>>::Combine(std::forward<F>(f), obs...);
+}
+
+template <typename F, typename... Us>
+Observable<std::invoke_result_t<F &, const Us &...>> Lazy(F &&f, const Observable<Us> &... obs) {
+  return Observable<std::invoke_result_t<F &, const Us &...>>::Lazy(std::forward<F>(f), obs...);
+}
+
+template <typename T>
+Observable<T> Coalesce(const Observable<T> &ob, IScheduler &scheduler) {
+  return Observable<T>::Paced(ob, Observable<T>::Pace::Coalesce, IScheduler::Clock::duration::zero(), scheduler);
+}
+
+template <typename T>
+Observable<T> Sample(const Observable<T> &ob, IScheduler::Clock::duration interval, IScheduler &scheduler) {
+  return Observable<T>::Paced(ob, Observable<T>::Pace::Sample, interval, scheduler);
+}
+
+template <typename T>
+Observable<T> Throttle(const Observable<T> &ob, IScheduler::Clock::duration interval, IScheduler &scheduler) {
+  return Observable<T>::Paced(ob, Observable<T>::Pace::Throttle, interval, scheduler);
+}
+
+template <typename T>
+Observable<T> Debounce(const Observable<T> &ob, IScheduler::Clock::duration interval, IScheduler &scheduler) {
+  return Observable<T>::Paced(ob, Observable<T>::Pace::Debounce, interval, scheduler);
 }
@@ -0,0 +1,190 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+// Recycles fixed size blocks through a thread local free list. The blocks
+// are carved from slabs which are kept until the thread exits, so objects
+// of the same size allocated and released in a steady pattern (e.g. the
+// nodes of a Chain) don't go through the global heap once warmed up.
+//
+// Like Chain, the pool isn't thread-safe: a block must be released on the
+// thread which allocated it, before that thread exits. It is therefore
+// opt-in, for containers confined to one thread. Structures which may be
+// released on another thread, like the observers of an Observable, use a
+// FreeList of their own instead.
+template <std::size_t Size, std::size_t Align>
+class FixedPool final
+{
+public:
+  static void *Allocate() {
+    FixedPool &pool = Instance();
+    if (pool.free_ == nullptr) {
+      pool.Grow();
+    }
+    Block *block = pool.free_;
+    pool.free_ = block->next;
+    return block->storage;
+  }
+
+  static void Deallocate(void *ptr) {
+    FixedPool &pool = Instance();
+    Block *block = reinterpret_cast<Block *>(ptr);
+    block->next = pool.free_;
+    pool.free_ = block;
+  }
+
+private:
+  union Block {
+    Block *next;
+    alignas(Align) std::byte storage[Size];
+  };
+
+  static constexpr std::size_t SlabSize = 64;
+
+  FixedPool(): slabs_(), free_(nullptr) { }
+
+  FixedPool(const FixedPool &) = delete;
+  FixedPool & operator = (const FixedPool &) = delete;
+
+  static FixedPool &Instance() {
+    thread_local FixedPool pool;
+    return pool;
+  }
+
+  void Grow() {
+    std::unique_ptr<Block[]> slab = std::make_unique<Block[]>(SlabSize);
+    for (std::size_t i = 0; i < SlabSize; i++) {
+      slab[i].next = free_;
+      free_ = &slab[i];
+    }
+    slabs_.push_back(std::move(slab));
+  }
+
+  std::vector<std::unique_ptr<Block[]>> slabs_;
+  Block *free_;
+};
+
+// A stateless allocator serving single objects from a FixedPool, arrays
+// fall back to std::allocator.
+template <typename T>
+class PoolAllocator
+{
+public:
+  using value_type = T;
+
+  PoolAllocator() = default;
+
+  template <typename U>
+  PoolAllocator(const PoolAllocator<U> &) { }
+
+  T *allocate(std::size_t n) {
+    if (n != 1) {
+      return std::allocator<T>().allocate(n);
+    }
+    return static_cast<T *>(FixedPool<sizeof(T), alignof(T)>::Allocate());
+  }
+
+  void deallocate(T *ptr, std::size_t n) {
+    if (n != 1) {
+      std::allocator<T>().deallocate(ptr, n);
+      return;
+    }
+    FixedPool<sizeof(T), alignof(T)>::Deallocate(ptr);
+  }
+
+  template <typename U>
+  bool operator == (const PoolAllocator<U> &) const { return true; }
+};
+
+// Caches released blocks of one size for a single owner, e.g. a Subject
+// recycling the nodes of its observers. The size is fixed by the first
+// allocation, smaller blocks are served from the list and larger ones go
+// to the global heap. The cached blocks are freed with the list.
+//
+// Unlike FixedPool the list has no thread affinity, it follows the rules
+// of the container it serves. It must outlive every block it handed out.
+class FreeList final
+{
+public:
+  FreeList(): size_(0), free_(nullptr) { }
+
+  FreeList(const FreeList &) = delete;
+  FreeList & operator = (const FreeList &) = delete;
+
+  ~FreeList() {
+    while (free_ != nullptr) {
+      ::operator delete(std::exchange(free_, free_->next), size_);
+    }
+  }
+
+  void *Allocate(std::size_t size) {
+    if (size_ == 0) {
+      size_ = std::max(size, sizeof(Block));
+    }
+    if (size > size_) {
+      return ::operator new(size);
+    }
+    if (free_ == nullptr) {
+      return ::operator new(size_);
+    }
+    return std::exchange(free_, free_->next);
+  }
+
+  void Deallocate(void *ptr, std::size_t size) {
+    if (size > size_) {
+      ::operator delete(ptr, size);
+      return;
+    }
+    free_ = ::new (ptr) Block { free_ };
+  }
+
+private:
+  struct Block {
+    Block *next;
+  };
+
+  std::size_t size_;
+  Block *free_;
+};
+
+// An allocator serving single objects from a FreeList it points to, arrays
+// and over-aligned types fall back to std::allocator.
+template <typename T>
+class FreeListAllocator
+{
+public:
+  using value_type = T;
+
+  FreeListAllocator(FreeList &list): list_(&list) { }
+
+  template <typename U>
+  FreeListAllocator(const FreeListAllocator<U> &alloc): list_(alloc.list_) { }
+
+  T *allocate(std::size_t n) {
+    if (n != 1 || alignof(T) > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+      return std::allocator<T>().allocate(n);
+    }
+    return static_cast<T *>(list_->Allocate(sizeof(T)));
+  }
+
+  void deallocate(T *ptr, std::size_t n) {
+    if (n != 1 || alignof(T) > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+      std::allocator<T>().deallocate(ptr, n);
+      return;
+    }
+    list_->Deallocate(ptr, sizeof(T));
+  }
+
+  template <typename U>
+  bool operator == (const FreeListAllocator<U> &alloc) const { return list_ == alloc.list_; }
+
+private:
+  template <typename U>
+  friend class FreeListAllocator;
+
+  FreeList *list_;
+};
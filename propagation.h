@@ -0,0 +1,254 @@
+#pragma once
+#include <cstddef>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "./chain.h"
+#include "./pool-allocator.h"
+
+// Schedules the recomputation of derived nodes in topological order.
+//
+// Every node has a height strictly greater than the height of each node
+// it depends on. Changed nodes only mark their dependents dirty, and the
+// dirty nodes are flushed from the lowest height up, so a node recomputes
+// at most once per update and never sees an inconsistent input.
+//
+// The dirty nodes are linked through themselves into one bucket per
+// height, so scheduling doesn't allocate once the buckets are grown.
+//
+// Each thread has its own scheduler, so graphs updated on different
+// threads flush independently. A single graph must still be updated from
+// one thread at a time.
+class Propagation final
+{
+public:
+  class Node;
+
+  class Node
+  {
+  public:
+    using Dependents = Chain<Node *, FreeListAllocator<Node *>>;
+
+    // Keeps a node in demand, the node is told when it gains its first
+    // demand and when it loses its last one.
+    class Demand
+    {
+    public:
+      // Keeps nothing in demand, until one is moved in.
+      Demand(): node_(nullptr) { }
+
+      Demand(Node &node): node_(&node) {
+        if (node_->demand_++ == 0) {
+          node_->Attach();
+        }
+      }
+
+      Demand(Demand &&demand): node_(std::exchange(demand.node_, nullptr)) { }
+      Demand & operator = (Demand &&demand) {
+        (*this)();
+        node_ = std::exchange(demand.node_, nullptr);
+        return *this;
+      }
+
+      Demand(const Demand &) = delete;
+      Demand & operator = (const Demand &) = delete;
+
+      ~Demand() { (*this)(); }
+
+      void operator () () {
+        if (Node *node = std::exchange(node_, nullptr); node != nullptr && --node->demand_ == 0) {
+          node->Detach();
+        }
+      }
+
+    private:
+      Node *node_;
+    };
+
+    // An edge to a node, keeping it in demand. Dropping it removes the edge.
+    class Dependency
+    {
+    public:
+      Dependency(Dependents::Deleter &&edge, Node &node): edge_(std::move(edge)), demand_(node) { }
+
+    private:
+      Dependents::Deleter edge_;
+      Demand demand_;
+    };
+
+    Node(): height_(0), demand_(0), edges_(), dependents_(edges_), queued_(std::nullopt), scheduler_(nullptr), prevQueued_(nullptr), nextQueued_(nullptr) { }
+
+    Node(const Node &) = delete;
+    Node & operator = (const Node &) = delete;
+
+    Node(Node &&) = delete;
+    Node & operator = (Node &&) = delete;
+
+    virtual ~Node() { Propagation::Cancel(*this); }
+
+    std::size_t Height() const { return height_; }
+
+    // Registers this node as a dependent of `node`. The returned deleter
+    // drops the edge when released.
+    Dependency DependOn(Node &node) {
+      RaiseHeight(node.height_ + 1);
+      return Dependency(node.dependents_.Add(this), node);
+    }
+
+    bool InDemand() const { return demand_ > 0; }
+
+  protected:
+    virtual void Recompute() { }
+
+    // Called when the node gains its first demand and when it loses its
+    // last one, e.g. to hook onto or unhook from its inputs.
+    virtual void Attach() { }
+    virtual void Detach() { }
+
+    void ScheduleDependents() {
+      dependents_.ForEach([](Node *node) { Propagation::Schedule(*node); });
+    }
+
+  private:
+    // Heights only grow, an edge to a higher node (e.g. a new inner
+    // observable of a join) lifts the whole downstream graph.
+    void RaiseHeight(std::size_t height) {
+      if (height <= height_) {
+        return;
+      }
+      height_ = height;
+      if (queued_.has_value()) {
+        Propagation::Cancel(*this);
+        Propagation::Schedule(*this);
+      }
+      dependents_.ForEach([height](Node *node) { node->RaiseHeight(height + 1); });
+    }
+
+    friend class Propagation;
+
+    std::size_t height_;
+    std::size_t demand_;
+    // Recycles the nodes of `dependents_`, which it must outlive.
+    FreeList edges_;
+    Dependents dependents_;
+    // The height of the bucket the node is queued in, if dirty.
+    std::optional<std::size_t> queued_;
+    // The scheduler of the thread the node is queued on, if dirty.
+    Propagation *scheduler_;
+    Node *prevQueued_;
+    Node *nextQueued_;
+  };
+
+public:
+  static void Schedule(Node &node) {
+    if (node.queued_.has_value()) {
+      return;
+    }
+    Propagation &self = Instance();
+    std::size_t height = node.height_;
+    if (height >= self.queue_.size()) {
+      self.queue_.resize(height + 1);
+    }
+    Bucket &bucket = self.queue_[height];
+    node.queued_ = height;
+    node.scheduler_ = &self;
+    node.prevQueued_ = bucket.last;
+    node.nextQueued_ = nullptr;
+    (bucket.last != nullptr ? bucket.last->nextQueued_ : bucket.first) = &node;
+    bucket.last = &node;
+    if (self.queued_++ == 0 || height < self.lowest_) {
+      self.lowest_ = height;
+    }
+  }
+
+  // Counts the changes of values, a node checked in the current epoch
+  // has seen all of them.
+  static std::size_t Epoch() { return Instance().epoch_; }
+  static void Advance() { Instance().epoch_ += 1; }
+
+  static void Cancel(Node &node) {
+    if (!node.queued_.has_value()) {
+      return;
+    }
+    Propagation &self = *node.scheduler_;
+    Bucket &bucket = self.queue_[node.queued_.value()];
+    (node.prevQueued_ != nullptr ? node.prevQueued_->nextQueued_ : bucket.first) = node.nextQueued_;
+    (node.nextQueued_ != nullptr ? node.nextQueued_->prevQueued_ : bucket.last) = node.prevQueued_;
+    node.prevQueued_ = nullptr;
+    node.nextQueued_ = nullptr;
+    node.queued_ = std::nullopt;
+    node.scheduler_ = nullptr;
+    self.queued_ -= 1;
+  }
+
+  // Recomputes all the dirty nodes. Nested calls (e.g. an updater invoked
+  // by an observer) are absorbed by the outermost flush, calls inside a
+  // batch are deferred to the end of the outermost batch.
+  static void Flush() {
+    Propagation &self = Instance();
+    if (self.flushing_ || self.batches_ > 0) {
+      return;
+    }
+
+    self.flushing_ = true;
+    struct Guard {
+      ~Guard() { flushing = false; }
+      bool &flushing;
+    } guard { self.flushing_ };
+
+    while (self.queued_ > 0) {
+      while (self.queue_[self.lowest_].first == nullptr) {
+        self.lowest_ += 1;
+      }
+      Node *node = self.queue_[self.lowest_].first;
+      Cancel(*node);
+      node->Recompute();
+    }
+  }
+
+  // Runs `f` as a single transaction. The nodes updated inside are only
+  // marked dirty, the dependents recompute and the observers fire once
+  // when the outermost batch returns.
+  //
+  // Updates can't be rolled back (e.g. a Modify is applied in place), so
+  // when `f` throws the updates it made so far are committed before the
+  // exception leaves the outermost batch, rather than left for some later
+  // update to flush.
+  template <typename F>
+  static void Batch(F &&f) {
+    Propagation &self = Instance();
+    self.batches_ += 1;
+    try {
+      f();
+    } catch (...) {
+      self.batches_ -= 1;
+      Flush();
+      throw;
+    }
+    self.batches_ -= 1;
+    Flush();
+  }
+
+private:
+  // The dirty nodes of a height, in the order they were scheduled.
+  struct Bucket {
+    Node *first = nullptr;
+    Node *last = nullptr;
+  };
+
+  Propagation(): queue_(), queued_(0), lowest_(0), flushing_(false), batches_(0), epoch_(0) { }
+
+  static Propagation &Instance() {
+    thread_local Propagation instance;
+    return instance;
+  }
+
+  // Indexed by height, no bucket below `lowest_` has a dirty node.
+  std::vector<Bucket> queue_;
+  std::size_t queued_;
+  std::size_t lowest_;
+  bool flushing_;
+  std::size_t batches_;
+  std::size_t epoch_;
+};
@@ -1,12 +1,14 @@
 #pragma once
 #include <functional>
+#include <type_traits>
+#include <utility>
 
 template <template <typename> typename M>
 struct Monad
 {
   template <typename T>
-  static constexpr M<T> Pure(const T &val) {
-    return M<T>::Pure(val);
+  static constexpr M<std::decay_t<T>> Pure(T &&val) {
+    return M<std::decay_t<T>>::Pure(std::forward<T>(val));
   }
 
   template <typename F, typename T> 
@@ -14,27 +16,41 @@ struct Monad
     return std::invoke_result_t<F, T>::Bind(mVal, std::forward<F>(f));
   }
 
+  // Uses the Map of the monad when it has one, it can transform the value
+  // in place instead of binding Pure.
   template <typename F, typename T>
   static constexpr M<std::invoke_result_t<F, T>> Map(F &&f, const M<T> &mVal) {
-    return Bind(mVal, [f = std::move(f)](const T &val) { return Pure(f(val)); });
+    using U = std::invoke_result_t<F, T>;
+    if constexpr (requires { M<U>::Map(std::forward<F>(f), mVal); }) {
+      return M<U>::Map(std::forward<F>(f), mVal);
+    } else {
+      return Bind(mVal, [f = std::forward<F>(f)](T &&val) { return Pure(f(std::move(val))); });
+    }
   }
 
   template <typename T>
   static constexpr M<T> Join(const M<M<T>> &mmVal) {
-    return Bind(mmVal, [](const M<T> &mVal) { return mVal; });
+    return Bind(mmVal, [](M<T> &&mVal) { return std::move(mVal); });
   }
 
   template <typename F, typename V>
   static constexpr M<std::invoke_result_t<F, V>> Lift(F &&f, const M<V> &mVal) {
-    return Map(std::move(f), mVal);
+    return Map(std::forward<F>(f), mVal);
   }
 
+  // Uses the Combine of the monad when it has one, it combines the
+  // independent values instead of binding them one by one.
   template <typename F, typename V, typename... Args>
   static constexpr auto Lift(F &&f, const M<V> &mVal, M<Args>... mArgs) {
-    return Bind(mVal, [f = std::move(f), mArgs...](const V &v) {
-      return Lift([f = std::move(f), v = v](const Args &... args) {
-        return f(v, args...);
-      }, mArgs...);
-    });
+    using R = std::invoke_result_t<F, V, Args...>;
+    if constexpr (requires { M<R>::Combine(std::forward<F>(f), mVal, mArgs...); }) {
+      return M<R>::Combine(std::forward<F>(f), mVal, mArgs...);
+    } else {
+      return Bind(mVal, [f = std::forward<F>(f), mArgs...](V &&v) {
+        return Lift([f, v = std::move(v)](const Args &... args) {
+          return f(v, args...);
+        }, mArgs...);
+      });
+    }
   }
 };
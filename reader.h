@@ -1,45 +1,283 @@
 #pragma once
+#include <algorithm>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "./lru-cache.h"
+#include "./trampoline.h"
 
 template <typename I>
 struct Reader {
+private:
+  // Spans a call of an outermost sharing reader, the shared readers it
+  // runs cache their results until it returns. The results of the thread
+  // keep their buckets between calls.
+  class Invocation final
+  {
+  public:
+    Invocation() { depth_ += 1; }
+
+    Invocation(const Invocation &) = delete;
+    Invocation & operator = (const Invocation &) = delete;
+
+    ~Invocation() {
+      if (--depth_ == 0) {
+        Results().Clear();
+      }
+    }
+
+    // The result of the sharing reader `shared` for the environment told
+    // apart by `key`, computed by `f` the first time.
+    //
+    // `eq` and `f` may run readers that share results too, so no iterator
+    // is held while they run: the results chained in a bucket are walked
+    // by index, and the walk starts over if `eq` grew the buckets.
+    template <typename T, typename K, typename Eq, typename F>
+    static T Share(const void *shared, std::size_t hash, K &&key, const Eq &eq, F &&f) {
+      Table &table = Results();
+      hash = hash * 31 + std::hash<const void *>()(shared);
+      for (std::size_t i = table.First(hash); i != 0;) {
+        Result &result = table.results[i - 1];
+        if (result.shared == shared && result.hash == hash) {
+          std::size_t grown = table.grown;
+          if (eq(result.key.template Get<std::decay_t<K>>(), key)) {
+            return result.value.template Get<T>();
+          }
+          if (grown != table.grown) {
+            i = table.First(hash);
+            continue;
+          }
+        }
+        i = result.next;
+      }
+      T value = f();
+      table.Add(Result { shared, hash, Erased(std::forward<K>(key)), Erased(value), 0 });
+      return value;
+    }
+
+  private:
+    struct Result {
+      const void *shared;
+      std::size_t hash;
+      Erased key;
+      Erased value;
+      // One past the index of the previous result in the bucket, 0 ends.
+      std::size_t next;
+    };
+
+    // The results by hash. A deque keeps the results in place while `eq`
+    // holds a key and a nested reader adds another one.
+    struct Table {
+      std::deque<Result> results;
+      // One past the index of the last result in each bucket.
+      std::vector<std::size_t> buckets;
+      std::size_t grown = 0;
+
+      std::size_t First(std::size_t hash) const {
+        return buckets.empty() ? 0 : buckets[hash & (buckets.size() - 1)];
+      }
+
+      void Add(Result &&result) {
+        results.push_back(std::move(result));
+        if (results.size() * 2 > buckets.size()) {
+          buckets.assign(std::max<std::size_t>(16, buckets.size() * 2), 0);
+          grown += 1;
+          for (std::size_t i = 0; i < results.size(); i++) {
+            Link(i);
+          }
+        } else {
+          Link(results.size() - 1);
+        }
+      }
+
+      void Link(std::size_t i) {
+        std::size_t &bucket = buckets[results[i].hash & (buckets.size() - 1)];
+        results[i].next = bucket;
+        bucket = i + 1;
+      }
+
+      void Clear() {
+        if (!results.empty()) {
+          results.clear();
+          std::fill(buckets.begin(), buckets.end(), 0);
+        }
+      }
+    };
+
+    // A function local, GCC mixes up the guards of several inline
+    // thread_local members of class templates.
+    static Table &Results() {
+      thread_local Table table;
+      return table;
+    }
+
+    static inline thread_local std::size_t depth_ = 0;
+  };
+
+public:
   template <typename T>
   class To
   {
   private:
+    template <typename> friend class To;
+
+    using Engine = Trampoline<Erased(const I &)>;
+
+    // A chain of binds, run by the trampoline in constant stack space.
+    class Bound
+    {
+    public:
+      Bound(typename Engine::Step step): step_(std::move(step)) {}
+      T operator () (const I &input) const { return Engine::Run(step_, input).template Take<T>(); }
+      const typename Engine::Step &Step() const { return step_; }
+    private:
+      typename Engine::Step step_;
+    };
+
     class ITo
     {
     public:
       virtual ~ITo() = default;
       virtual T operator() (const I &input) = 0;
+      virtual const typename Engine::Step *AsStep() const = 0;
     };
 
     template <typename F>
     class ToImpl: public ITo {
     public:
-      ToImpl(F &&f): f_(std::forward<F>(f)) {}
+      template <typename A>
+      ToImpl(A &&f): f_(std::forward<A>(f)) {}
       virtual T operator () (const I &input) override { return f_(input); }
+      virtual const typename Engine::Step *AsStep() const override {
+        if constexpr (std::is_same_v<F, Bound>) {
+          return &f_.Step();
+        } else {
+          return nullptr;
+        }
+      }
     private:
       F f_;
     };
 
+    typename Engine::Step ToStep() const {
+      if (const typename Engine::Step *step = ptr_->AsStep()) {
+        return *step;
+      }
+      return Engine::Leaf([to = *this](const I &input) { return Erased(to(input)); });
+    }
+
     std::shared_ptr<ITo> ptr_;
+    // Whether the reader runs a shared reader, so that its calls span an
+    // invocation.
+    bool shares_ = false;
 
   public:
     template <typename F>
+      requires (!std::is_same_v<std::remove_cvref_t<F>, To>)
     To(F &&f):
-      ptr_(new ToImpl<F>(std::forward<F>(f))) {}
+      ptr_(new ToImpl<std::decay_t<F>>(std::forward<F>(f))) {}
 
-    T operator () (const I &input) const { return (*ptr_)(input); }
+    T operator () (const I &input) const {
+      if (shares_) {
+        Invocation invocation;
+        return (*ptr_)(input);
+      }
+      return (*ptr_)(input);
+    }
 
     static constexpr To Pure(const T &val) {
       return To([val = val] (const I &) { return val; });
     }
 
+    static constexpr To Pure(T &&val) {
+      return To([val = std::move(val)] (const I &) { return val; });
+    }
+
+    // Shares results with the readers `f` returns if `mVal` is a sharing
+    // reader, which a Bind can only tell of its first reader.
     template <typename F, typename U>
     static constexpr To Bind(const To<U> &mVal, F &&f) {
-      return To([mVal = mVal, f = std::move(f)](const I &input) {
-        return f(mVal(input))(input);
+      To to(Bound(Engine::Bind(mVal.ToStep(), [f = std::forward<F>(f)](Erased &&val) {
+        return To(f(val.Take<U>())).ToStep();
+      })));
+      to.shares_ = mVal.shares_;
+      return to;
+    }
+
+    // Functor::Map, applied in place by the trampoline.
+    template <typename F, typename U>
+    static constexpr To Map(F &&f, const To<U> &mVal) {
+      To to(Bound(Engine::template Map<U, T>(mVal.ToStep(), std::forward<F>(f))));
+      to.shares_ = mVal.shares_;
+      return to;
+    }
+
+    // Applicative, `f` of the results of all the readers for the same
+    // environment. The readers run nested rather than on the trampoline.
+    template <typename F, typename... Us>
+    static To Combine(F &&f, const To<Us> &... mVals) {
+      To to([f = std::forward<F>(f), mVals...](const I &input) {
+        return f(mVals(input)...);
+      });
+      to.shares_ = (mVals.shares_ || ...);
+      return to;
+    }
+
+    // Caches the results of `reader` for the last `capacity` environments,
+    // told apart by `key(input)`. The copies of the returned reader share
+    // the cache, which isn't thread-safe.
+    template <typename Key = std::identity,
+              typename K = std::decay_t<std::invoke_result_t<const Key &, const I &>>,
+              typename Hash = std::hash<K>>
+    static To Memoize(const To &reader, std::size_t capacity, Key key = Key(), Hash hash = Hash()) {
+      auto cache = std::make_shared<LruCache<K, T, Hash>>(capacity, hash);
+      To to([reader, cache, key = std::move(key)](const I &input) {
+        K k = key(input);
+        if (T *found = cache->Find(k)) {
+          return *found;
+        }
+        T value = reader(input);
+        cache->Add(std::move(k), value);
+        return value;
+      });
+      to.shares_ = reader.shares_;
+      return to;
+    }
+
+    // Runs `reader` once per environment in a call of an outermost sharing
+    // reader, however many times the readers composed into it by Map, Bind
+    // or Combine use it. The environments are told apart by `key(input)`,
+    // the copies of the returned reader share the results.
+    //
+    // Only the readers composed from a shared one open an invocation. A
+    // reader written by hand that runs shared readers shares their results
+    // when it is itself Shared.
+    template <typename Key = std::identity,
+              typename K = std::decay_t<std::invoke_result_t<const Key &, const I &>>,
+              typename Eq = std::equal_to<K>,
+              typename Hash = std::hash<K>>
+    static To Shared(const To &reader, Key key = Key(), Eq eq = Eq(), Hash hash = Hash()) {
+      struct Sharing {
+        To reader;
+        Key key;
+        Eq eq;
+        Hash hash;
+      };
+      auto sharing = std::make_shared<const Sharing>(Sharing { reader, std::move(key), std::move(eq), std::move(hash) });
+      To to([sharing](const I &input) {
+        K k = sharing->key(input);
+        std::size_t h = sharing->hash(k);
+        return Invocation::template Share<T>(sharing.get(), h, std::move(k), sharing->eq, [&sharing, &input]() {
+          return sharing->reader(input);
+        });
       });
+      to.shares_ = true;
+      return to;
     }
   };
-};
\ No newline at end of file
+};
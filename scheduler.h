@@ -0,0 +1,83 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <variant>
+
+#include "effect.h"
+
+// Where and when timed work runs. The observables aren't thread-safe, a
+// scheduler of timed observables must run the work on their thread.
+class IScheduler
+{
+public:
+  using Clock = std::chrono::steady_clock;
+  using Work = Effect<std::monostate>;
+
+  virtual ~IScheduler() = default;
+  virtual Clock::time_point Now() const = 0;
+  virtual void PostAt(Clock::time_point at, Work work) = 0;
+};
+
+// The work posted to a scheduler, in the order it falls due.
+class TimerQueue final
+{
+public:
+  void Add(IScheduler::Clock::time_point at, IScheduler::Work work) {
+    works_.emplace(at, std::move(work));
+  }
+
+  // Runs the works due at `now`, including the ones they post.
+  void RunUntil(IScheduler::Clock::time_point now) {
+    while (!works_.empty() && works_.begin()->first <= now) {
+      IScheduler::Work work = std::move(works_.begin()->second);
+      works_.erase(works_.begin());
+      work();
+    }
+  }
+
+  bool Empty() const { return works_.empty(); }
+  IScheduler::Clock::time_point Next() const { return works_.begin()->first; }
+
+private:
+  std::multimap<IScheduler::Clock::time_point, IScheduler::Work> works_;
+};
+
+// Keeps the time of the steady clock, the owner of the observables' thread
+// (e.g. its event loop) runs the due work by calling `RunDue`.
+class PolledScheduler final: public IScheduler
+{
+public:
+  virtual Clock::time_point Now() const override { return Clock::now(); }
+  virtual void PostAt(Clock::time_point at, Work work) override { queue_.Add(at, std::move(work)); }
+
+  void RunDue() { queue_.RunUntil(Now()); }
+
+private:
+  TimerQueue queue_;
+};
+
+// A virtual time which only moves when advanced, for deterministic tests.
+class ManualScheduler final: public IScheduler
+{
+public:
+  ManualScheduler(): now_() { }
+
+  virtual Clock::time_point Now() const override { return now_; }
+  virtual void PostAt(Clock::time_point at, Work work) override { queue_.Add(at, std::move(work)); }
+
+  // Moves the time forward by `duration`, running the works falling due
+  // on the way at their time.
+  void Advance(Clock::duration duration) {
+    Clock::time_point until = now_ + duration;
+    while (!queue_.Empty() && queue_.Next() <= until) {
+      now_ = std::max(now_, queue_.Next());
+      queue_.RunUntil(now_);
+    }
+    now_ = until;
+  }
+
+private:
+  Clock::time_point now_;
+  TimerQueue queue_;
+};
@@ -0,0 +1,59 @@
+#pragma once
+#include <type_traits>
+#include <utility>
+
+#include "./effect.h"
+
+// An effect keeping the type of its callable. Map and Bind compose the
+// callables directly into a new StaticEffect, so a pipeline built from
+// lambdas inlines like the handwritten lambda would. Erase() turns it into
+// an Effect when it has to be stored or passed around.
+template <typename F>
+class StaticEffect final
+{
+public:
+  using Value = std::invoke_result_t<const F &>;
+
+  constexpr StaticEffect(F f): f_(std::move(f)) { }
+
+  constexpr Value operator () () const { return f_(); }
+
+  // Functor::Map
+  template <typename G>
+  constexpr auto Map(G g) const {
+    return ::StaticEffect([f = f_, g = std::move(g)]() {
+      if constexpr (std::is_void_v<Value>) {
+        f();
+        return g();
+      } else {
+        return g(f());
+      }
+    });
+  }
+
+  // Monad::Bind, `g` returns a StaticEffect or an Effect.
+  template <typename G>
+  constexpr auto Bind(G g) const {
+    return ::StaticEffect([f = f_, g = std::move(g)]() {
+      if constexpr (std::is_void_v<Value>) {
+        f();
+        return g()();
+      } else {
+        return g(f())();
+      }
+    });
+  }
+
+  Effect<std::conditional_t<std::is_void_v<Value>, std::monostate, Value>> Erase() const {
+    return f_;
+  }
+
+private:
+  F f_;
+};
+
+// Monad::Pure
+template <typename T>
+constexpr auto PureEffect(T val) {
+  return StaticEffect([val = std::move(val)]() { return val; });
+}
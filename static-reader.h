@@ -0,0 +1,51 @@
+#pragma once
+#include <type_traits>
+#include <utility>
+
+#include "./reader.h"
+
+// A reader keeping the type of its callable. Map and Bind compose the
+// callables directly into a new StaticReader::To, Erase() turns it into a
+// Reader::To.
+template <typename I>
+struct StaticReader {
+  template <typename F>
+  class To
+  {
+  public:
+    using Value = std::invoke_result_t<const F &, const I &>;
+
+    constexpr To(F f): f_(std::move(f)) { }
+
+    constexpr Value operator () (const I &input) const { return f_(input); }
+
+    // Functor::Map
+    template <typename G>
+    constexpr auto Map(G g) const {
+      return StaticReader::To([f = f_, g = std::move(g)](const I &input) {
+        return g(f(input));
+      });
+    }
+
+    // Monad::Bind, `g` returns a StaticReader::To or a Reader::To.
+    template <typename G>
+    constexpr auto Bind(G g) const {
+      return StaticReader::To([f = f_, g = std::move(g)](const I &input) {
+        return g(f(input))(input);
+      });
+    }
+
+    typename Reader<I>::template To<Value> Erase() const {
+      return F(f_);
+    }
+
+  private:
+    F f_;
+  };
+
+  // Monad::Pure
+  template <typename T>
+  static constexpr auto Pure(T val) {
+    return To([val = std::move(val)](const I &) { return val; });
+  }
+};
@@ -1,8 +1,25 @@
 #pragma once
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <stop_token>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
 #include "effect.h"
+#include "executor.h"
 #include "reader.h"
 #include "single-execution.h"
+#include "trampoline.h"
 
+// A computation calling back with its value, possibly later and on
+// another thread. Running a task again runs it again, except for a task
+// returned by a coroutine (see coroutine.h), which only runs once.
 template <typename T>
 class Task
 {
@@ -10,45 +27,368 @@ public:
   using UnitEffect = Effect<std::monostate>;
   using Callback = typename Reader<T>::To<UnitEffect>;
 private:
+  template <typename> friend class Task;
+
+  using ErasedCallback = std::function<UnitEffect(Erased &&)>;
+  using Engine = Trampoline<UnitEffect(const ErasedCallback &, const std::stop_token &)>;
+
+  // A chain of binds, run by the trampoline in constant stack space.
+  class Bound
+  {
+  public:
+    Bound(typename Engine::Step step): step_(std::move(step)) {}
+    UnitEffect operator () (const Callback &cb, const std::stop_token &token) const {
+      return Run(step_, {}, [cb = cb](Erased &&val) {
+        return cb(val.Take<T>());
+      }, token);
+    }
+    const typename Engine::Step &Step() const { return step_; }
+  private:
+    typename Engine::Step step_;
+  };
+
   class ITask
   {
   public:
     virtual ~ITask() = default;
-    virtual UnitEffect operator () (const Callback &cb) = 0;
+    virtual UnitEffect operator () (const Callback &cb, const std::stop_token &token) = 0;
+    virtual const typename Engine::Step *AsStep() const = 0;
+    virtual const T *AsValue() const = 0;
+  };
+
+  // A task completing right away with `val`.
+  struct Value
+  {
+    UnitEffect operator () (const Callback &cb) const { return cb(val); }
+    T val;
   };
 
   template <typename F>
   class TaskImpl: public ITask
   {
   public:
-    TaskImpl(F &&f): f_(std::forward<F>(f)) {}
-    virtual UnitEffect operator () (const Callback &cb) override {
-      return SingleExecution(f_(cb));
+    template <typename A>
+    TaskImpl(A &&f): f_(std::forward<A>(f)) {}
+    virtual UnitEffect operator () (const Callback &cb, const std::stop_token &token) override {
+      if constexpr (std::is_invocable_v<F &, const Callback &, const std::stop_token &>) {
+        return f_(cb, token);
+      } else {
+        return f_(cb);
+      }
+    }
+    virtual const typename Engine::Step *AsStep() const override {
+      if constexpr (std::is_same_v<F, Bound>) {
+        return &f_.Step();
+      } else {
+        return nullptr;
+      }
+    }
+    virtual const T *AsValue() const override {
+      if constexpr (std::is_same_v<F, Value>) {
+        return &f_.val;
+      } else {
+        return nullptr;
+      }
     }
   private:
     F f_;
   };
 
+  // The state of a leaf waiting for its callback. Only the thread running
+  // the loop touches `running` and `value`.
+  //
+  // A stop request releases the continuations right away, whoever holds
+  // the callback of the leaf. The callback deregisters `onStop` before
+  // touching `stack` or `done`, which waits for a release in progress.
+  struct Suspended
+  {
+    struct Release
+    {
+      void operator () () const {
+        suspended->stack.clear();
+        suspended->done = nullptr;
+      }
+      Suspended *suspended;
+    };
+
+    Suspended(typename Engine::Stack &&stack, const ErasedCallback &done, const std::stop_token &token):
+      stack(std::move(stack)), done(done), thread(std::this_thread::get_id()),
+      running(true), value(std::nullopt), onStop() {
+      if (token.stop_possible()) {
+        onStop.emplace(token, Release{ this });
+      }
+    }
+
+    Suspended(const Suspended &) = delete;
+    Suspended & operator = (const Suspended &) = delete;
+
+    typename Engine::Stack stack;
+    ErasedCallback done;
+    const std::thread::id thread;
+    bool running;
+    std::optional<Erased> value;
+    std::optional<std::stop_callback<Release>> onStop;
+  };
+
+  // Runs `step` and the continuations left on `stack`, then `done`. A leaf
+  // calling back synchronously only records its value and the loop goes
+  // on, a leaf calling back later or from another thread resumes the loop
+  // from its callback, on that thread. The effects of the leaves completed
+  // in the loop run in order.
+  //
+  // Once `token` is stopped no more leaves start and no more continuations
+  // apply, `done` is never called.
+  static UnitEffect Run(typename Engine::Step step, typename Engine::Stack stack, ErasedCallback done, const std::stop_token &token) {
+    std::vector<UnitEffect> effects;
+    while (!token.stop_requested()) {
+      const auto &leaf = Engine::Unwind(step, stack);
+      auto suspended = std::make_shared<Suspended>(std::move(stack), done, token);
+      effects.push_back(leaf.Invoke([suspended, token](Erased &&val) {
+        if (suspended->thread == std::this_thread::get_id() && suspended->running) {
+          suspended->value = std::move(val);
+          return UnitEffect([] {});
+        }
+        suspended->onStop.reset();
+        if (token.stop_requested()) {
+          return UnitEffect([] {});
+        }
+        return Resume(std::move(suspended->stack), std::move(val), suspended->done, token);
+      }, token));
+      suspended->running = false;
+
+      if (!suspended->value.has_value()) {
+        break;
+      }
+      suspended->onStop.reset();
+      if (token.stop_requested()) {
+        break;
+      }
+      stack = std::move(suspended->stack);
+      step = Engine::Continue(stack, suspended->value.value());
+      if (!step) {
+        effects.push_back(done(std::move(suspended->value.value())));
+        break;
+      }
+    }
+
+    return UnitEffect::Sequence(std::move(effects));
+  }
+
+  static UnitEffect Resume(typename Engine::Stack stack, Erased &&val, const ErasedCallback &done, const std::stop_token &token) {
+    typename Engine::Step step = Engine::Continue(stack, val);
+    if (!step) {
+      return done(std::move(val));
+    }
+    return Run(std::move(step), std::move(stack), done, token);
+  }
+
+  typename Engine::Step ToStep() const {
+    if (const typename Engine::Step *step = ptr_->AsStep()) {
+      return *step;
+    }
+    return Engine::Leaf([task = *this](const ErasedCallback &cb, const std::stop_token &token) {
+      return task(Callback([cb = cb](const T &val) { return cb(Erased(val)); }), token);
+    });
+  }
+
   std::shared_ptr<ITask> ptr_;
 public:
   template <typename F>
+    requires (!std::is_same_v<std::remove_cvref_t<F>, Task>)
   Task(F &&f):
-    ptr_(new TaskImpl<F>(std::forward<F>(f))) { }
-  
-  UnitEffect operator () (const Callback &cb) {
-    return (*ptr_)(cb);
+    ptr_(std::make_shared<TaskImpl<std::decay_t<F>>>(std::forward<F>(f))) { }
+
+  // Runs this task. A task made of a function taking the stop token as
+  // well can give up early once `token` is stopped, the binds skip their
+  // continuations and release them. The returned effect runs at most
+  // once, the last copy runs it if nobody did.
+  UnitEffect operator () (const Callback &cb, const std::stop_token &token = {}) const {
+    return UnitEffect([once = std::make_shared<SingleExecution<UnitEffect>>((*ptr_)(cb, token))] { (*once)(); });
+  }
+
+  // Runs this task along with the effect it returns. The effect then
+  // needs no guard against running twice or being dropped unrun.
+  void Start(const Callback &cb, const std::stop_token &token = {}) const {
+    (*ptr_)(cb, token)();
+  }
+
+  // The value of a task made by Pure, which completes right away, or
+  // nullptr for any other task.
+  const T *Ready() const { return ptr_->AsValue(); }
+
+  // Starts this task by posting it to `executor`, the posted work does
+  // nothing once stopped.
+  Task StartOn(IExecutor &executor) const {
+    return Task([task = *this, &executor](const Callback &cb, const std::stop_token &token) {
+      executor.Post([task, cb, token]() {
+        if (!token.stop_requested()) {
+          task(cb, token)();
+        }
+      });
+      return UnitEffect([] {});
+    });
+  }
+
+  // Delivers the result of this task by posting the callback to
+  // `executor`, the continuations bound after it run there.
+  Task ContinueOn(IExecutor &executor) const {
+    return Task([task = *this, &executor](const Callback &cb, const std::stop_token &token) {
+      return task(Callback([cb, token, &executor](const T &val) {
+        executor.Post([cb, token, val]() {
+          if (!token.stop_requested()) {
+            cb(val)();
+          }
+        });
+        return UnitEffect([] {});
+      }), token);
+    });
   }
 
   static constexpr Task Pure(const T &val) {
-    return Task([val = val](const Callback &cb) { return cb(val); });
+    return Task(Value { val });
+  }
+
+  static constexpr Task Pure(T &&val) {
+    return Task(Value { std::move(val) });
   }
 
   template <typename F, typename U>
   static constexpr Task Bind(const Task<U> &mVal, F &&f) {
-    return Task([mVal = mVal, f = std::move(f)](const Callback &cb) {
-      return mVal([cb = cb, f = std::move(f)](const U &val) {
-        return f(val)(cb);
-      });
-    });
+    return Task(Bound(Engine::Bind(mVal.ToStep(), [f = std::forward<F>(f)](Erased &&val) {
+      return Task(f(val.Take<U>())).ToStep();
+    })));
+  }
+
+  // Functor::Map, applied in place by the trampoline.
+  template <typename F, typename U>
+  static constexpr Task Map(F &&f, const Task<U> &mVal) {
+    return Task(Bound(Engine::template Map<U, T>(mVal.ToStep(), std::forward<F>(f))));
   }
 };
+
+// Starts all the tasks at once and completes with all their results, in
+// the order of the arguments, when the last one completes. The results
+// are collected in one shared slot array.
+template <typename... Ts>
+Task<std::tuple<Ts...>> WhenAll(const Task<Ts> &... tasks) {
+  using Result = std::tuple<Ts...>;
+  using UnitEffect = typename Task<Result>::UnitEffect;
+
+  struct State
+  {
+    State(const typename Task<Result>::Callback &cb): results(), remaining(sizeof...(Ts)), cb(cb) {}
+
+    std::tuple<std::optional<Ts>...> results;
+    std::atomic<std::size_t> remaining;
+    typename Task<Result>::Callback cb;
+  };
+
+  return Task<Result>([tasks...](const typename Task<Result>::Callback &cb, const std::stop_token &token) {
+    if constexpr (sizeof...(Ts) == 0) {
+      return cb(Result());
+    } else {
+      auto state = std::make_shared<State>(cb);
+      std::vector<UnitEffect> effects;
+      effects.reserve(sizeof...(Ts));
+      [&]<std::size_t... Is>(std::index_sequence<Is...>) {
+        (effects.push_back(tasks(typename Task<Ts>::Callback([state](const Ts &val) {
+          std::get<Is>(state->results) = val;
+          if (state->remaining.fetch_sub(1) != 1) {
+            return UnitEffect([] {});
+          }
+          return state->cb(std::apply([](auto &... results) {
+            return Result(std::move(results.value())...);
+          }, state->results));
+        }), token)), ...);
+      }(std::index_sequence_for<Ts...>{});
+      return UnitEffect::Sequence(std::move(effects));
+    }
+  });
+}
+
+template <typename T>
+Task<std::vector<T>> WhenAll(std::vector<Task<T>> tasks) {
+  using Result = std::vector<T>;
+  using UnitEffect = typename Task<Result>::UnitEffect;
+
+  struct State
+  {
+    State(std::size_t size, const typename Task<Result>::Callback &cb): results(size), remaining(size), cb(cb) {}
+
+    std::vector<std::optional<T>> results;
+    std::atomic<std::size_t> remaining;
+    typename Task<Result>::Callback cb;
+  };
+
+  return Task<Result>([tasks = std::move(tasks)](const typename Task<Result>::Callback &cb, const std::stop_token &token) {
+    if (tasks.empty()) {
+      return cb(Result());
+    }
+    auto state = std::make_shared<State>(tasks.size(), cb);
+    std::vector<UnitEffect> effects;
+    effects.reserve(tasks.size());
+    for (std::size_t i = 0; i < tasks.size(); i++) {
+      effects.push_back(tasks[i](typename Task<T>::Callback([state, i](const T &val) {
+        state->results[i] = val;
+        if (state->remaining.fetch_sub(1) != 1) {
+          return UnitEffect([] {});
+        }
+        Result results;
+        results.reserve(state->results.size());
+        for (std::optional<T> &result : state->results) {
+          results.push_back(std::move(result.value()));
+        }
+        return state->cb(results);
+      }), token));
+    }
+    return UnitEffect::Sequence(std::move(effects));
+  });
+}
+
+// Starts all the tasks at once and completes with the result of the first
+// one to complete, the others are then stopped. Never completes without
+// any task.
+template <typename T>
+Task<T> WhenAny(std::vector<Task<T>> tasks) {
+  using UnitEffect = typename Task<T>::UnitEffect;
+
+  struct Forward
+  {
+    void operator () () { source.request_stop(); }
+    std::stop_source source;
+  };
+
+  // The tasks run under their own stop source, stopped along with the
+  // outer token.
+  struct State
+  {
+    State(const typename Task<T>::Callback &cb, const std::stop_token &token):
+      done(false), cb(cb), source(), link(token, Forward{ source }) {}
+
+    std::atomic<bool> done;
+    typename Task<T>::Callback cb;
+    std::stop_source source;
+    std::stop_callback<Forward> link;
+  };
+
+  return Task<T>([tasks = std::move(tasks)](const typename Task<T>::Callback &cb, const std::stop_token &token) {
+    auto state = std::make_shared<State>(cb, token);
+    std::vector<UnitEffect> effects;
+    effects.reserve(tasks.size());
+    for (const Task<T> &task : tasks) {
+      effects.push_back(task(typename Task<T>::Callback([state](const T &val) {
+        if (state->done.exchange(true)) {
+          return UnitEffect([] {});
+        }
+        state->source.request_stop();
+        return state->cb(val);
+      }), state->source.get_token()));
+    }
+    return UnitEffect::Sequence(std::move(effects));
+  });
+}
+
+template <typename T, typename... Ts>
+Task<T> WhenAny(const Task<T> &task, const Task<Ts> &... tasks) {
+  return WhenAny(std::vector<Task<T>>{ task, tasks... });
+}
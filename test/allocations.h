@@ -0,0 +1,6 @@
+#pragma once
+#include <cstddef>
+
+// The number of calls to the global operator new so far, it is replaced
+// in allocations.cpp to count the heap allocations of the tests.
+std::size_t Allocations();
@@ -1,9 +1,12 @@
 #include <catch2/catch_test_macros.hpp>
+#include <optional>
 #include <vector>
 #include "../chain.h"
+#include "../pool-allocator.h"
+#include "./allocations.h"
 
-template <typename T>
-std::vector<T> toVector(const Chain<T> &chain) {
+template <typename T, typename A>
+std::vector<T> toVector(const Chain<T, A> &chain) {
   std::vector<T> vec;
   chain.ForEach([&](const T &v) { vec.push_back(v); });
   return vec;
@@ -104,3 +107,147 @@ TEST_CASE("Memory management", "[Chain]") {
   chain.Add(Tracker{});
   REQUIRE(Tracker::count == 2);
 }
+
+template <typename T>
+struct CountingAllocator {
+  using value_type = T;
+
+  CountingAllocator(int *count): count(count) {}
+  template <typename U>
+  CountingAllocator(const CountingAllocator<U> &alloc): count(alloc.count) {}
+
+  T *allocate(std::size_t n) {
+    *count += 1;
+    return std::allocator<T>().allocate(n);
+  }
+  void deallocate(T *ptr, std::size_t n) {
+    *count -= 1;
+    std::allocator<T>().deallocate(ptr, n);
+  }
+
+  template <typename U>
+  bool operator == (const CountingAllocator<U> &alloc) const { return count == alloc.count; }
+
+  int *count;
+};
+
+TEST_CASE("Custom allocator", "[Chain]") {
+  int count = 0;
+  Chain<int, CountingAllocator<int>> chain{CountingAllocator<int>(&count)};
+
+  auto rm1 = chain.Add(1);
+  REQUIRE(count == 1);
+
+  do {
+    auto rm2 = chain.Add(2);
+    REQUIRE(count == 2);
+    REQUIRE(toVector(chain) == std::vector<int>{1, 2});
+  } while (0);
+
+  REQUIRE(count == 1);
+
+  auto rm3 = std::move(rm1);
+  REQUIRE(count == 1);
+  rm3();
+  REQUIRE(count == 0);
+  REQUIRE(toVector(chain) == std::vector<int>{});
+}
+
+TEST_CASE("Remove elements while iterating", "[Chain]") {
+  Chain<int> chain;
+  std::vector<std::optional<Chain<int>::Deleter>> rms;
+  for (int i = 0; i < 5; i++) {
+    rms.emplace_back(chain.Add(int(i)));
+  }
+
+  // Each element removes itself and the one after it.
+  std::vector<int> visited;
+  chain.ForEach([&](int v) {
+    visited.push_back(v);
+    rms[v] = std::nullopt;
+    if (v + 1 < 5) {
+      rms[v + 1] = std::nullopt;
+    }
+  });
+  REQUIRE(visited == std::vector<int>{0, 2, 4});
+  REQUIRE(toVector(chain) == std::vector<int>{});
+}
+
+TEST_CASE("Add elements while iterating", "[Chain]") {
+  Chain<int> chain;
+  auto rm1 = chain.Add(1);
+  auto rm2 = chain.Add(2);
+  std::vector<Chain<int>::Deleter> added;
+
+  std::vector<int> visited;
+  chain.ForEach([&](int v) {
+    visited.push_back(v);
+    added.push_back(chain.Add(v * 10));
+  });
+  REQUIRE(visited == std::vector<int>{1, 2});
+  REQUIRE(toVector(chain) == std::vector<int>{1, 2, 10, 20});
+}
+
+TEST_CASE("Nested iterations", "[Chain]") {
+  Chain<int> chain;
+  auto rm1 = chain.Add(1);
+  std::optional<Chain<int>::Deleter> rm2 = chain.Add(2);
+  auto rm3 = chain.Add(3);
+
+  std::vector<int> visited;
+  chain.ForEach([&](int v) {
+    chain.ForEach([&](int w) {
+      visited.push_back(v * 10 + w);
+      rm2 = std::nullopt;
+    });
+  });
+  REQUIRE(visited == std::vector<int>{11, 13, 31, 33});
+}
+
+TEST_CASE("Clear while iterating", "[Chain]") {
+  Chain<int> chain;
+  auto rm1 = chain.Add(1);
+  auto rm2 = chain.Add(2);
+
+  std::vector<int> visited;
+  chain.ForEach([&](int v) {
+    visited.push_back(v);
+    chain.Clear();
+  });
+  REQUIRE(visited == std::vector<int>{1});
+  REQUIRE(toVector(chain) == std::vector<int>{});
+}
+
+TEST_CASE("Iterating doesn't allocate", "[Chain]") {
+  Chain<int> chain;
+  std::vector<Chain<int>::Deleter> rms;
+  for (int i = 0; i < 100; i++) {
+    rms.push_back(chain.Add(int(i)));
+  }
+  std::size_t allocations = Allocations();
+  int sum = 0;
+  chain.ForEach([&](int v) { sum += v; });
+  REQUIRE(sum == 4950);
+  REQUIRE(Allocations() == allocations);
+}
+
+TEST_CASE("Embedded hooks", "[Chain]") {
+  Chain<int> chain;
+  auto rm1 = chain.Add(1);
+  {
+    Chain<int>::Hook hook2(2), hook3(3);
+    REQUIRE(!hook2.Linked());
+    std::size_t allocations = Allocations();
+    chain.Link(hook2);
+    chain.Link(hook3);
+    chain.Link(hook2);
+    REQUIRE(Allocations() == allocations);
+    REQUIRE(hook2.Linked());
+    REQUIRE(toVector(chain) == std::vector<int>{1, 3, 2});
+
+    hook3.Unlink();
+    REQUIRE(!hook3.Linked());
+    REQUIRE(toVector(chain) == std::vector<int>{1, 2});
+  }
+  REQUIRE(toVector(chain) == std::vector<int>{1});
+}
@@ -0,0 +1,119 @@
+#include <catch2/catch_test_macros.hpp>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../concurrent-observable.h"
+#include "../monad.h"
+
+TEST_CASE("Observe and unobserve", "[ConcurrentObservable]") {
+  int calls = 0;
+  auto [x, UpdateX] = ConcurrentObservable<int>::Mutable(0);
+
+  auto unob1 = x.Observe([&calls](int newVal, int oldVal) {
+    REQUIRE(newVal == oldVal + 1);
+    calls++;
+  });
+  UpdateX(1);
+  REQUIRE(calls == 1);
+  REQUIRE(x.Value() == 1);
+
+  unob1();
+  UpdateX(2);
+  REQUIRE(calls == 1);
+
+  do {
+    auto unob2 = x.Observe([&calls](int, int) { calls++; });
+    UpdateX(3);
+    REQUIRE(calls == 2);
+  } while (0);
+
+  UpdateX(4);
+  REQUIRE(calls == 2);
+}
+
+TEST_CASE("Map as Functor", "[ConcurrentObservable]") {
+  auto [x, UpdateX] = ConcurrentObservable<int>::Mutable(0);
+  ConcurrentObservable<std::string> str = Monad<ConcurrentObservable>::Map([](int i) {
+    return std::to_string(i);
+  }, x);
+
+  REQUIRE(str.Value() == "0");
+  UpdateX(42);
+  REQUIRE(str.Value() == "42");
+}
+
+TEST_CASE("Update from many threads", "[ConcurrentObservable]") {
+  constexpr int threads = 8;
+  constexpr int updates = 1000;
+
+  std::atomic<int> calls = 0;
+  std::atomic<int> odds = 0;
+  auto [x, UpdateX] = ConcurrentObservable<int>::Mutable(-1);
+  auto y = Monad<ConcurrentObservable>::Map([](int n) { return n * 2; }, x);
+  auto unob = y.Observe([&calls, &odds](int newVal, int) {
+    odds += newVal % 2;
+    calls++;
+  });
+
+  std::vector<std::thread> workers;
+  for (int i = 0; i < threads; i++) {
+    workers.emplace_back([i, UpdateX = UpdateX]() {
+      for (int j = 0; j < updates; j++) {
+        UpdateX(i * updates + j);
+      }
+    });
+  }
+  for (auto &worker : workers) {
+    worker.join();
+  }
+
+  REQUIRE(y.Value() == x.Value() * 2);
+  REQUIRE(odds == 0);
+  REQUIRE(calls > 0);
+  REQUIRE(calls <= threads * updates);
+}
+
+TEST_CASE("Subscribe while notifying", "[ConcurrentObservable]") {
+  std::atomic<bool> done = false;
+  std::atomic<int> calls = 0;
+  auto [x, UpdateX] = ConcurrentObservable<int>::Mutable(0);
+
+  std::thread notifier([&done, UpdateX = UpdateX]() {
+    for (int i = 1; !done; i++) {
+      UpdateX(i);
+    }
+  });
+
+  for (int i = 0; i < 1000; i++) {
+    auto unob = x.Observe([&calls](int, int) { calls++; });
+  }
+  done = true;
+  notifier.join();
+
+  int settled = calls;
+  UpdateX(-1);
+  REQUIRE(calls == settled);
+}
+
+TEST_CASE("Unobserve waits for notifications in flight", "[ConcurrentObservable]") {
+  std::atomic<bool> entered = false;
+  std::atomic<bool> left = false;
+  auto [x, UpdateX] = ConcurrentObservable<int>::Mutable(0);
+
+  auto unob = x.Observe([&entered, &left](int, int) {
+    entered = true;
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    left = true;
+  });
+  std::thread notifier([UpdateX = UpdateX]() { UpdateX(1); });
+  while (!entered) {
+    std::this_thread::yield();
+  }
+
+  unob();
+  REQUIRE(left);
+  notifier.join();
+}
@@ -0,0 +1,32 @@
+#pragma once
+#include <cstddef>
+
+// A payload counting its copies into `copies`, to check that the values
+// are moved through the pipelines.
+class CopyCounter final
+{
+public:
+  CopyCounter(int value, std::size_t &copies): value_(value), copies_(&copies) { }
+
+  CopyCounter(const CopyCounter &counter): value_(counter.value_), copies_(counter.copies_) {
+    *copies_ += 1;
+  }
+
+  CopyCounter & operator = (const CopyCounter &counter) {
+    value_ = counter.value_;
+    copies_ = counter.copies_;
+    *copies_ += 1;
+    return *this;
+  }
+
+  CopyCounter(CopyCounter &&) = default;
+  CopyCounter & operator = (CopyCounter &&) = default;
+
+  int Value() const { return value_; }
+
+  bool operator == (const CopyCounter &counter) const { return value_ == counter.value_; }
+
+private:
+  int value_;
+  std::size_t *copies_;
+};
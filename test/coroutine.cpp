@@ -0,0 +1,163 @@
+#include <catch2/catch_test_macros.hpp>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <latch>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <stop_token>
+
+#include "../coroutine.h"
+#include "../executor.h"
+#include "./allocations.h"
+
+namespace {
+  template <typename T>
+  class CountingAllocator
+  {
+  public:
+    using value_type = T;
+
+    CountingAllocator(std::size_t &allocated): allocated_(&allocated) { }
+    template <typename U>
+    CountingAllocator(const CountingAllocator<U> &alloc): allocated_(alloc.allocated_) { }
+
+    T *allocate(std::size_t n) {
+      *allocated_ += 1;
+      return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T *ptr, std::size_t n) {
+      *allocated_ -= 1;
+      std::allocator<T>().deallocate(ptr, n);
+    }
+
+    std::size_t *allocated_;
+  };
+
+  template <typename T>
+  std::optional<T> Await(const Task<T> &task) {
+    std::optional<T> result;
+    task([&result](const T &val) { return [&result, val]() { result = val; }; });
+    return result;
+  }
+
+  Task<int> Add(Task<int> a, Effect<int> b) {
+    int x = co_await a;
+    int y = co_await b;
+    co_return x + y;
+  }
+
+  Task<int> Sum(int n) {
+    int sum = 0;
+    for (int i = 1; i <= n; i++) {
+      sum += co_await Task<int>::Pure(i);
+    }
+    co_return sum;
+  }
+
+  Task<int> Allocated(std::allocator_arg_t, [[maybe_unused]] CountingAllocator<std::byte> alloc, int n) {
+    co_return co_await Task<int>::Pure(n);
+  }
+}
+
+TEST_CASE("Await tasks and effects", "[Coroutine]") {
+  REQUIRE(Await(Add(Task<int>::Pure(1), Effect<int>::Pure(2))) == 3);
+}
+
+TEST_CASE("Coroutine starts when the task runs", "[Coroutine]") {
+  int runs = 0;
+  auto task = Add(Task<int>::Pure(1), Effect<int>([&runs]() { return ++runs; }));
+  REQUIRE(runs == 0);
+  REQUIRE(Await(task) == 2);
+  REQUIRE(runs == 1);
+}
+
+TEST_CASE("Await many synchronous tasks", "[Coroutine]") {
+  REQUIRE(Await(Sum(60000)) == 1800030000);
+}
+
+TEST_CASE("Awaiting a pure task doesn't suspend", "[Coroutine]") {
+  auto task = Sum(1000);
+  std::size_t allocations = Allocations();
+  REQUIRE(Await(task) == 500500);
+  // The tasks made by Pure, nothing per await.
+  REQUIRE(Allocations() - allocations <= 1000 + 8);
+}
+
+TEST_CASE("Coroutine task runs once", "[Coroutine]") {
+  auto task = Sum(3);
+  REQUIRE(Await(task) == 6);
+  REQUIRE_THROWS_AS(Await(task), std::logic_error);
+}
+
+TEST_CASE("Await asynchronous task", "[Coroutine]") {
+  std::optional<Task<int>::Callback> pending;
+  auto task = Add(Task<int>([&pending](const Task<int>::Callback &cb) {
+    pending = cb;
+    return Task<int>::UnitEffect([] {});
+  }), Effect<int>::Pure(2));
+
+  std::optional<int> result;
+  task([&result](int n) { return [&result, n]() { result = n; }; })();
+  REQUIRE(!result.has_value());
+  pending.value()(1)();
+  REQUIRE(result == 3);
+}
+
+TEST_CASE("Await task on thread pool", "[Coroutine]") {
+  ThreadPool pool(2);
+  std::atomic<int> result = 0;
+  std::latch done(1);
+
+  auto task = Add(Task<int>::Pure(1).StartOn(pool), Effect<int>::Pure(2));
+  task([&result, &done](int n) {
+    return [&result, &done, n]() {
+      result = n;
+      done.count_down();
+    };
+  })();
+  done.wait();
+  REQUIRE(result == 3);
+}
+
+TEST_CASE("Unstarted coroutine releases its frame", "[Coroutine]") {
+  std::size_t allocated = 0;
+  {
+    auto task = Allocated(std::allocator_arg, CountingAllocator<std::byte>(allocated), 1);
+    REQUIRE(allocated == 1);
+  }
+  REQUIRE(allocated == 0);
+}
+
+TEST_CASE("Coroutine frame from allocator", "[Coroutine]") {
+  std::size_t allocated = 0;
+  auto task = Allocated(std::allocator_arg, CountingAllocator<std::byte>(allocated), 4);
+  REQUIRE(allocated == 1);
+  REQUIRE(Await(task) == 4);
+  REQUIRE(allocated == 0);
+}
+
+TEST_CASE("Stopped coroutine is destroyed", "[Coroutine]") {
+  std::optional<Task<int>::Callback> pending;
+  auto later = Task<int>::Bind(Task<int>([&pending](const Task<int>::Callback &cb) {
+    pending = cb;
+    return Task<int>::UnitEffect([] {});
+  }), [](int n) { return Task<int>::Pure(n); });
+
+  auto alive = std::make_shared<int>(0);
+  std::weak_ptr<int> weak = alive;
+  auto task = Add(later, Effect<int>([alive = std::move(alive)]() { return *alive; }));
+
+  std::stop_source source;
+  std::optional<int> result;
+  task([&result](int n) { return [&result, n]() { result = n; }; }, source.get_token())();
+  task = Task<int>::Pure(0);
+  REQUIRE(!weak.expired());
+
+  source.request_stop();
+  REQUIRE(weak.expired());
+  pending.value()(1)();
+  REQUIRE(!result.has_value());
+}
@@ -1,8 +1,12 @@
 #include <catch2/catch_test_macros.hpp>
+#include <functional>
+#include <memory>
 #include <string>
 #include "../effect.h"
 #include "../pure-bind-monad.h"
 #include "../single-execution.h"
+#include "./allocations.h"
+#include "./copy-counter.h"
 
 TEST_CASE("Execute effect", "[Effect]") {
   int n = 10;
@@ -79,3 +83,121 @@ TEST_CASE("SingleExecution with Effect", "[Effect]") {
   }
   REQUIRE(n == 12);
 }
+
+TEST_CASE("Small effects are stored inline", "[Effect]") {
+  int n = 10;
+  std::size_t allocations = Allocations();
+
+  auto eff1 = Effect<int>::Pure(123);
+  auto eff2 = eff1;
+  auto eff3 = Effect<int>([&n]() { return n++; });
+  auto eff4 = Effect<int>::Pure(0);
+  eff4 = eff3;
+  auto eff5 = Effect([&n]() { n++; });
+  eff5();
+
+  REQUIRE(eff1() == 123);
+  REQUIRE(eff2() == 123);
+  REQUIRE(eff3() == 11);
+  REQUIRE(eff4() == 12);
+  REQUIRE(Allocations() == allocations);
+}
+
+TEST_CASE("Stateful effects are shared between copies", "[Effect]") {
+  auto eff1 = Effect<int>([n = 0]() mutable { return n++; });
+  auto eff2 = eff1;
+
+  REQUIRE(eff1() == 0);
+  REQUIRE(eff2() == 1);
+  REQUIRE(eff1() == 2);
+}
+
+TEST_CASE("Deep bind chains", "[Effect]") {
+  constexpr int depth = 1000000;
+
+  auto left = Effect<int>::Pure(0);
+  for (int i = 0; i < depth; i++) {
+    left = Monad<Effect>::Bind(left, [](int v) { return Effect<int>::Pure(v + 1); });
+  }
+  REQUIRE(left() == depth);
+
+  std::function<Effect<int>(int)> loop = [&loop](int v) {
+    return v == depth ? Effect<int>::Pure(v) : Monad<Effect>::Bind(Effect<int>::Pure(v + 1), loop);
+  };
+  REQUIRE(Monad<Effect>::Bind(Effect<int>::Pure(0), loop)() == depth);
+}
+
+TEST_CASE("Deep map chains", "[Effect]") {
+  constexpr int depth = 1000000;
+
+  auto eff = Effect<int>::Pure(0);
+  for (int i = 0; i < depth; i++) {
+    eff = Monad<Effect>::Map([](int v) { return v + 1; }, eff);
+  }
+  REQUIRE(eff() == depth);
+}
+
+TEST_CASE("Consecutive maps don't allocate", "[Effect]") {
+  auto eff = Effect<int>([]() { return 1; });
+  auto once = Monad<Effect>::Map([](int v) { return v + 1; }, eff);
+  auto many = once;
+  for (int i = 0; i < 10; i++) {
+    many = Monad<Effect>::Map([](int v) { return v + 1; }, many);
+  }
+  REQUIRE(once() == 2);
+  REQUIRE(many() == 12);
+
+  std::size_t allocations = Allocations();
+  once();
+  std::size_t onceAllocations = Allocations() - allocations;
+  allocations = Allocations();
+  many();
+  REQUIRE(Allocations() - allocations == onceAllocations);
+}
+
+TEST_CASE("A chain of maps allocates one node per map", "[Effect]") {
+  auto eff = Monad<Effect>::Map([](int v) { return v + 1; }, Effect<int>([]() { return 1; }));
+  std::size_t allocations = Allocations();
+  for (int i = 0; i < 100; i++) {
+    eff = Monad<Effect>::Map([](int v) { return v + 1; }, eff);
+  }
+  REQUIRE(Allocations() - allocations == 100);
+
+  // The maps run in fused stages, the stack of the run is its only
+  // allocation.
+  allocations = Allocations();
+  REQUIRE(eff() == 102);
+  REQUIRE(Allocations() - allocations == 1);
+}
+
+TEST_CASE("Map after bind", "[Effect]") {
+  auto eff = Monad<Effect>::Bind(Effect<int>::Pure(1), [](int v) { return Effect<int>::Pure(v * 10); });
+  auto mapped = Monad<Effect>::Map([](int v) { return std::to_string(v); },
+    Monad<Effect>::Map([](int v) { return v + 1; }, eff));
+  REQUIRE(mapped() == "11");
+  REQUIRE(eff() == 10);
+}
+
+TEST_CASE("Move-only results", "[Effect]") {
+  auto eff = Effect<std::unique_ptr<int>>([]() { return std::make_unique<int>(1); });
+  auto mapped = Monad<Effect>::Map([](std::unique_ptr<int> &&p) {
+    *p += 1;
+    return std::move(p);
+  }, eff);
+  auto bound = Monad<Effect>::Bind(mapped, [](std::unique_ptr<int> &&p) {
+    return Effect<int>::Pure(*p * 10);
+  });
+  REQUIRE(bound() == 20);
+  REQUIRE(bound() == 20);
+}
+
+TEST_CASE("Results are moved through binds", "[Effect]") {
+  std::size_t copies = 0;
+  auto eff = Effect<CopyCounter>([&copies]() { return CopyCounter(1, copies); });
+  auto mapped = Monad<Effect>::Map([](CopyCounter &&c) { return std::move(c); }, eff);
+  auto bound = Monad<Effect>::Bind(mapped, [&copies](CopyCounter &&c) {
+    return Effect<CopyCounter>([&copies, v = c.Value()]() { return CopyCounter(v + 1, copies); });
+  });
+  REQUIRE(bound().Value() == 2);
+  REQUIRE(copies == 0);
+}
@@ -0,0 +1,150 @@
+#include <catch2/catch_test_macros.hpp>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <future>
+#include <latch>
+#include <mutex>
+#include <set>
+#include <thread>
+
+#include "../executor.h"
+#include "../task2.h"
+
+TEST_CASE("Inline executor", "[Executor]") {
+  int n = 0;
+  InlineExecutor executor;
+  executor.Post([&n]() { n++; });
+  REQUIRE(n == 1);
+}
+
+TEST_CASE("Thread pool runs posted work", "[Executor]") {
+  constexpr int works = 10000;
+  std::atomic<int> n = 0;
+  std::latch done(works);
+
+  ThreadPool pool(4);
+  REQUIRE(pool.Size() == 4);
+  for (int i = 0; i < works; i++) {
+    pool.Post([&n, &done]() {
+      n++;
+      done.count_down();
+    });
+  }
+  done.wait();
+  REQUIRE(n == works);
+}
+
+TEST_CASE("Thread pool runs nested work", "[Executor]") {
+  constexpr int fanout = 100;
+  std::atomic<int> n = 0;
+  std::latch done(fanout * fanout);
+
+  ThreadPool pool(4);
+  for (int i = 0; i < fanout; i++) {
+    pool.Post([&pool, &n, &done]() {
+      for (int j = 0; j < fanout; j++) {
+        pool.Post([&n, &done]() {
+          n++;
+          done.count_down();
+        });
+      }
+    });
+  }
+  done.wait();
+  REQUIRE(n == fanout * fanout);
+}
+
+TEST_CASE("Thread pool finishes posted work on destruction", "[Executor]") {
+  std::atomic<int> n = 0;
+  {
+    ThreadPool pool(2);
+    for (int i = 0; i < 100; i++) {
+      pool.Post([&n]() { n++; });
+    }
+  }
+  REQUIRE(n == 100);
+}
+
+TEST_CASE("Start task on executor", "[Executor]") {
+  ThreadPool pool(2);
+  std::promise<std::thread::id> ran;
+
+  auto task = Task<int>([&ran](const Task<int>::Callback &cb) {
+    ran.set_value(std::this_thread::get_id());
+    return cb(1);
+  }).StartOn(pool);
+
+  std::promise<int> result;
+  task([&result](int n) { return [&result, n]() { result.set_value(n); }; });
+
+  REQUIRE(ran.get_future().get() != std::this_thread::get_id());
+  REQUIRE(result.get_future().get() == 1);
+}
+
+TEST_CASE("Stopped task posted to executor doesn't run", "[Executor]") {
+  std::atomic<int> runs = 0;
+  std::latch blocked(1);
+  std::stop_source source;
+  {
+    ThreadPool pool(1);
+    pool.Post([&blocked]() { blocked.wait(); });
+
+    auto task = Task<int>([&runs](const Task<int>::Callback &cb) {
+      runs++;
+      return cb(1);
+    }).StartOn(pool);
+    task([](int) { return [](){}; }, source.get_token())();
+
+    source.request_stop();
+    blocked.count_down();
+  }
+  REQUIRE(runs == 0);
+}
+
+TEST_CASE("Continue task on executor", "[Executor]") {
+  ThreadPool pool(2);
+  std::promise<std::thread::id> ran;
+
+  auto task = Task<int>::Bind(Task<int>::Pure(1).ContinueOn(pool), [&ran](int n) {
+    ran.set_value(std::this_thread::get_id());
+    return Task<int>::Pure(n + 1);
+  });
+
+  std::promise<int> result;
+  task([&result](int n) { return [&result, n]() { result.set_value(n); }; });
+
+  REQUIRE(ran.get_future().get() != std::this_thread::get_id());
+  REQUIRE(result.get_future().get() == 2);
+}
+
+TEST_CASE("WhenAll runs tasks in parallel", "[Executor]") {
+  constexpr int tasks = 4;
+  ThreadPool pool(tasks);
+  std::mutex mutex;
+  std::condition_variable cv;
+  int started = 0;
+
+  // Each child waits for all the others to start, which only happens when
+  // they run at the same time.
+  auto child = [&](int n) {
+    return Task<int>([&, n](const Task<int>::Callback &cb) {
+      std::unique_lock<std::mutex> lock(mutex);
+      started++;
+      cv.notify_all();
+      bool together = cv.wait_for(lock, std::chrono::seconds(10), [&]() { return started == tasks; });
+      return cb(together ? n : -1);
+    }).StartOn(pool);
+  };
+
+  std::vector<Task<int>> children;
+  for (int i = 0; i < tasks; i++) {
+    children.push_back(child(i));
+  }
+
+  std::promise<std::vector<int>> result;
+  WhenAll(children)([&result](const std::vector<int> &val) {
+    return [&result, val]() { result.set_value(val); };
+  });
+  REQUIRE(result.get_future().get() == std::vector<int>{0, 1, 2, 3});
+}
@@ -0,0 +1,89 @@
+#include <catch2/catch_test_macros.hpp>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+#include "../maybe-column.h"
+
+template <typename T>
+std::vector<Maybe<T>> toRows(const MaybeColumn<T> &column) {
+  std::vector<Maybe<T>> rows;
+  for (std::size_t i = 0; i < column.Size(); i++) {
+    rows.push_back(column[i]);
+  }
+  return rows;
+}
+
+TEST_CASE("Column of maybe values", "[MaybeColumn]") {
+  MaybeColumn<int> column(std::vector<Maybe<int>>{ 1, Maybe<int>(), 3 });
+  REQUIRE(column.Size() == 3);
+  REQUIRE(column.Count() == 2);
+  REQUIRE(column.Values() == std::vector<int>{ 1, 0, 3 });
+  REQUIRE(column.Validity() == std::vector<std::uint64_t>{ 0b101 });
+
+  column.Set(1, 2);
+  column.Reset(0);
+  REQUIRE(toRows(column) == std::vector<Maybe<int>>{ Maybe<int>(), 2, 3 });
+
+  MaybeColumn<int> all(std::vector<int>(70, 1));
+  REQUIRE(all.Count() == 70);
+  REQUIRE(all.Validity() == std::vector<std::uint64_t>{ ~std::uint64_t(0), 0b111111 });
+
+  REQUIRE_THROWS_AS(MaybeColumn<int>(std::vector<int>(70), { 0 }), std::invalid_argument);
+  MaybeColumn<int> masked(std::vector<int>{ 5, 6 }, { 0b10 });
+  REQUIRE(toRows(masked) == std::vector<Maybe<int>>{ Maybe<int>(), 6 });
+}
+
+TEST_CASE("Map column", "[MaybeColumn]") {
+  MaybeColumn<int> column(std::vector<Maybe<int>>{ 1, Maybe<int>(), 3 });
+  auto mapped = column.Map([](int n) { return n * 0.5; });
+  REQUIRE(toRows(mapped) == std::vector<Maybe<double>>{ 0.5, Maybe<double>(), 1.5 });
+
+  auto shifted = MaybeColumn<int>(column).Map([](int n) { return n + 10; });
+  REQUIRE(toRows(shifted) == std::vector<Maybe<int>>{ 11, Maybe<int>(), 13 });
+  REQUIRE(toRows(column) == std::vector<Maybe<int>>{ 1, Maybe<int>(), 3 });
+
+  auto positive = column.Map([](int n) { return n > 1; });
+  REQUIRE(toRows(positive) == std::vector<Maybe<bool>>{ false, Maybe<bool>(), true });
+}
+
+TEST_CASE("Lift columns", "[MaybeColumn]") {
+  std::vector<Maybe<int>> xs, ys, zs;
+  for (int i = 0; i < 200; i++) {
+    xs.push_back(i % 2 == 0 ? Maybe<int>(i) : Maybe<int>());
+    ys.push_back(i % 3 == 0 ? Maybe<int>(i) : Maybe<int>());
+    zs.push_back(Maybe<int>(1));
+  }
+  auto sum = Lift([](int x, int y, int z) { return x + y + z; }, MaybeColumn<int>(xs), MaybeColumn<int>(ys), MaybeColumn<int>(zs));
+  REQUIRE(sum.Size() == 200);
+  for (int i = 0; i < 200; i++) {
+    REQUIRE(sum[i] == (i % 6 == 0 ? Maybe<int>(2 * i + 1) : Maybe<int>()));
+  }
+
+  REQUIRE_THROWS_AS(Lift([](int x, int y) { return x + y; }, MaybeColumn<int>(1), MaybeColumn<int>(2)), std::invalid_argument);
+}
+
+TEST_CASE("Missing slots hold the default value", "[MaybeColumn]") {
+  int max = std::numeric_limits<int>::max();
+  MaybeColumn<int> masked(std::vector<int>{ max, 1 }, { 0b10 });
+  REQUIRE(masked.Values() == std::vector<int>{ 0, 1 });
+
+  MaybeColumn<int> column(std::vector<int>{ 1, max });
+  column.Reset(1);
+  REQUIRE(column.Values() == std::vector<int>{ 1, 0 });
+
+  // The maps run on the missing slots too, which hold no INT_MAX to
+  // overflow, and leave them at the default value.
+  auto plus = [](int n) { return n + 1; };
+  REQUIRE(masked.Map(plus).Values() == std::vector<int>{ 0, 2 });
+  REQUIRE(MaybeColumn<int>(column).Map(plus).Values() == std::vector<int>{ 2, 0 });
+  auto sum = Lift([](int x, int y) { return x + y; }, masked, column);
+  REQUIRE(sum.Values() == std::vector<int>{ 0, 0 });
+  REQUIRE(toRows(sum) == std::vector<Maybe<int>>{ Maybe<int>(), Maybe<int>() });
+}
+
+TEST_CASE("Bind column", "[MaybeColumn]") {
+  MaybeColumn<int> column(std::vector<Maybe<int>>{ 4, Maybe<int>(), 0, 2 });
+  auto halved = column.Bind([](int n) { return n != 0 ? Maybe<int>(8 / n) : Maybe<int>(); });
+  REQUIRE(toRows(halved) == std::vector<Maybe<int>>{ 2, Maybe<int>(), Maybe<int>(), 4 });
+}
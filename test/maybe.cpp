@@ -1,6 +1,13 @@
 #include <catch2/catch_test_macros.hpp>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <stdexcept>
 #include "../monad.h"
 #include "../maybe.h"
+#include "./copy-counter.h"
 
 TEST_CASE("Map as Functor", "[Maybe]") {
   auto x = Maybe<int>(0);
@@ -80,3 +87,143 @@ TEST_CASE("Lift Calls", "[Maybe]") {
   REQUIRE(u.HasValue() == true);
   REQUIRE(u.Value() == 2);
 }
+
+TEST_CASE("Move-only values", "[Maybe]") {
+  auto x = Monad<Maybe>::Pure(std::make_unique<int>(1));
+  auto y = Monad<Maybe>::Map([](std::unique_ptr<int> &&p) {
+    *p += 1;
+    return std::move(p);
+  }, std::move(x));
+  auto z = Monad<Maybe>::Bind(std::move(y), [](std::unique_ptr<int> &&p) {
+    return Maybe(std::make_unique<int>(*p * 10));
+  });
+  REQUIRE(*z.Value() == 20);
+
+  auto w = Monad<Maybe>::Join(Maybe<Maybe<std::unique_ptr<int>>>(Maybe(std::make_unique<int>(3))));
+  REQUIRE(*w.Value() == 3);
+}
+
+TEST_CASE("Values are moved through pipelines", "[Maybe]") {
+  std::size_t copies = 0;
+  auto x = Monad<Maybe>::Pure(CopyCounter(1, copies));
+  auto y = Monad<Maybe>::Map([](CopyCounter &&c) { return std::move(c); }, std::move(x));
+  auto z = Monad<Maybe>::Bind(std::move(y), [](CopyCounter &&c) { return Maybe(std::move(c)); });
+  REQUIRE(z.Value().Value() == 1);
+  REQUIRE(copies == 0);
+}
+
+TEST_CASE("Lift moves the function once", "[Maybe]") {
+  std::size_t copies = 0;
+  auto w = Monad<Maybe>::Lift([counter = CopyCounter(1, copies)](int x, int y, int z, int u) {
+    return counter.Value() + x + y + z + u;
+  }, Maybe(1), Maybe(2), Maybe(3), Maybe(4));
+
+  REQUIRE(w.Value() == 11);
+  REQUIRE(copies == 0);
+}
+
+// A monad without Combine, which Lift binds value by value.
+template <typename T>
+class Box {
+public:
+  Box(const T &value): value_(value) { }
+  template <typename F, typename U>
+  Box(const F &f, const Box<U> &box): value_(f(box.Value())) { }
+  Box(const Box<Box<T>> &box): value_(box.Value().Value()) { }
+
+  const T &Value() const { return value_; }
+
+private:
+  T value_;
+};
+
+TEST_CASE("Lift copies each bound value once", "[Monad]") {
+  std::size_t copies = 0;
+  Box<CopyCounter> a(CopyCounter(1, copies)), b(CopyCounter(2, copies)), c(CopyCounter(3, copies)), d(CopyCounter(4, copies));
+  copies = 0;
+
+  auto sum = Monad<Box>::Lift([](const CopyCounter &x, const CopyCounter &y, const CopyCounter &z, const CopyCounter &u) {
+    return x.Value() * 1000 + y.Value() * 100 + z.Value() * 10 + u.Value();
+  }, a, std::move(b), std::move(c), std::move(d));
+
+  REQUIRE(sum.Value() == 1234);
+  // The values bound before the last one.
+  REQUIRE(copies == 3);
+}
+
+constexpr Maybe<int> ParseDigit(char c) {
+  return c >= '0' && c <= '9' ? Maybe<int>(c - '0') : Maybe<int>();
+}
+
+constexpr Maybe<int> ParseNumber(const char *s) {
+  Maybe<int> number(0);
+  for (; *s != '\0'; s++) {
+    number = Monad<Maybe>::Lift([](int n, int d) { return n * 10 + d; }, number, ParseDigit(*s));
+  }
+  return number;
+}
+
+TEST_CASE("Compile-time pipelines", "[Maybe]") {
+  static_assert(Monad<Maybe>::Map([](int n) { return n + 1; }, Maybe<int>(1)) == Maybe<int>(2));
+  static_assert(!Monad<Maybe>::Bind(Maybe<int>(), [](int n) { return Maybe<int>(n); }).HasValue());
+  static_assert(Monad<Maybe>::Join(Maybe<Maybe<int>>(Maybe<int>(3))).Value() == 3);
+  static_assert((Maybe<int>(2) >> [](int n) { return Maybe<int>(n * 2); } >> [](int n) { return n + 1; }).Value() == 5);
+  static_assert(ParseNumber("1234").Value() == 1234);
+  static_assert(!ParseNumber("12a4"));
+
+  constexpr std::array<Maybe<int>, 3> table = { ParseNumber("7"), ParseNumber("x"), ParseNumber("42") };
+  static_assert(table[0].Value() == 7 && !table[1] && table[2].Value() == 42);
+  REQUIRE(table[2].Value() == 42);
+}
+
+enum class Slot: std::uint32_t { };
+
+template <>
+struct MaybeNiche<Slot>: SentinelNiche<Slot, Slot(~0u)> { };
+
+struct Aligned {
+  int value;
+};
+
+template <>
+struct MaybeNiche<Aligned *>: AlignedPointerNiche<Aligned> { };
+
+TEST_CASE("Spare representations", "[Maybe]") {
+  static_assert(sizeof(Maybe<double>) == sizeof(double));
+  static_assert(sizeof(Maybe<float>) == sizeof(float));
+  static_assert(sizeof(Maybe<Slot>) == sizeof(Slot));
+  static_assert(sizeof(Maybe<Aligned *>) == sizeof(Aligned *));
+  static_assert(sizeof(Maybe<int>) > sizeof(int));
+  // Pointers only spare an address when their type opts in.
+  static_assert(!has_niche<int *>);
+
+  static_assert(Maybe<Slot>(Slot(3)).Value() == Slot(3));
+  static_assert(!Maybe<Slot>().HasValue());
+  static_assert(Maybe<Slot>() == Maybe<Slot>());
+  static_assert(!(Maybe<Slot>(Slot(0)) == Maybe<Slot>()));
+  static_assert(Monad<Maybe>::Join(Maybe<Maybe<Slot>>(Maybe<Slot>(Slot(1)))).Value() == Slot(1));
+  static_assert(Monad<Maybe>::Join(Maybe<Maybe<double>>(Maybe<double>(0.5))).Value() == 0.5);
+
+  double nan = std::numeric_limits<double>::quiet_NaN();
+  REQUIRE(Maybe<double>(nan).HasValue());
+  REQUIRE(!Maybe<double>().HasValue());
+  REQUIRE(!(Maybe<double>(nan) == Maybe<double>(nan)));
+  REQUIRE(Maybe<double>() == Maybe<double>());
+  REQUIRE(!(Maybe<double>(1.0) == Maybe<double>()));
+  REQUIRE(Monad<Maybe>::Map([](double d) { return d * 0.0 / 0.0; }, Maybe<double>(1.0)).HasValue());
+
+  Aligned a { 1 };
+  REQUIRE(Maybe<Aligned *>(nullptr).HasValue());
+  REQUIRE(Maybe<Aligned *>(&a).Value() == &a);
+  REQUIRE(!Maybe<Aligned *>().HasValue());
+  auto deref = Monad<Maybe>::Bind(Maybe<Aligned *>(&a), [](Aligned *p) { return Maybe<int>(p->value + 1); });
+  REQUIRE(deref.Value() == 2);
+
+  // The spare representation is no value, making a Maybe of it throws
+  // rather than making a missing value.
+  REQUIRE_THROWS_AS(Maybe<Slot>(Slot(~0u)), std::invalid_argument);
+  REQUIRE_THROWS_AS(Monad<Maybe>::Map([](Slot) { return Slot(~0u); }, Maybe<Slot>(Slot(0))), std::invalid_argument);
+  REQUIRE(!Monad<Maybe>::Map([](Slot) { return Slot(~0u); }, Maybe<Slot>()).HasValue());
+  REQUIRE_THROWS_AS(Maybe<double>(std::bit_cast<double>(0x7ff000000000deadull)), std::invalid_argument);
+  REQUIRE_THROWS_AS(Maybe<Aligned *>(reinterpret_cast<Aligned *>(alignof(Aligned) - 1)), std::invalid_argument);
+}
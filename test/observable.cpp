@@ -1,11 +1,16 @@
 #include <catch2/catch_test_macros.hpp>
+#include <chrono>
 #include <vector>
 #include <utility>
 #include <memory>
+#include <stdexcept>
 #include <format>
+#include <thread>
 
 #include "../observable.h"
 #include "../monad.h"
+#include "./allocations.h"
+#include "./copy-counter.h"
 
 template <typename T>
 class MockObserver {
@@ -32,6 +37,22 @@ private:
   std::shared_ptr<std::vector<std::pair<T, T>>> calls_;
 };
 
+struct Versioned {
+  int value;
+  std::size_t version;
+  std::size_t Version() const { return version; }
+};
+
+template <>
+struct ChangeDetection<Versioned>: CompareVersions { };
+
+struct Unequal {
+  int value;
+};
+
+template <>
+struct ChangeDetection<Unequal>: AlwaysChanged { };
+
 TEST_CASE("Observe and unobserve", "[Observable]") {
   MockObserver<int> ob;
 
@@ -278,3 +299,611 @@ TEST_CASE("Integrated test case", "[Observable]") {
   REQUIRE(obs.Value() == 12);
   REQUIRE(ob.callCount() == 1);
 }
+
+TEST_CASE("Glitch-free propagation", "[Observable]") {
+  MockObserver<int> ob;
+  int mapCalls = 0;
+  auto [x, UpdateX] = Observable<int>::Mutable(1);
+
+  // x -> a, b -> c -> d forms a diamond, c must see a and b updated together.
+  auto a = Monad<Observable>::Map([](int n) { return n + 1; }, x);
+  auto b = Monad<Observable>::Map([](int n) { return n * 2; }, x);
+  auto c = Monad<Observable>::Lift([](int a, int b) { return a + b; }, a, b);
+  auto d = Monad<Observable>::Map([&mapCalls](int n) { mapCalls++; return n; }, c);
+
+  REQUIRE(c.Value() == 4);
+  REQUIRE(d.Value() == 4);
+
+  auto unob = c.Observe(ob);
+  mapCalls = 0;
+
+  UpdateX(2);
+  REQUIRE(c.Value() == 7);
+  REQUIRE(d.Value() == 7);
+  REQUIRE(ob.callCount() == 1);
+  REQUIRE(ob.lastCallArgs() == std::pair{7, 4});
+  REQUIRE(mapCalls == 1);
+
+  UpdateX(3);
+  REQUIRE(c.Value() == 10);
+  REQUIRE(d.Value() == 10);
+  REQUIRE(ob.callCount() == 2);
+  REQUIRE(ob.lastCallArgs() == std::pair{10, 7});
+  REQUIRE(mapCalls == 2);
+}
+
+TEST_CASE("Join switching to a higher inner observable", "[Observable]") {
+  MockObserver<int> ob;
+  auto [x, UpdateX] = Observable<int>::Mutable(0);
+  auto deep = Monad<Observable>::Map([](int n) { return n + 1; },
+    Monad<Observable>::Map([](int n) { return n + 1; },
+      Monad<Observable>::Map([](int n) { return n + 1; }, x)));
+  auto [z, UpdateZ] = Observable<Observable<int>>::Mutable(x);
+  Observable<int> w(z);
+  auto v = Monad<Observable>::Map([](int n) { return n * 10; }, w);
+
+  auto unob = v.Observe(ob);
+
+  UpdateZ(deep);
+  REQUIRE(w.Value() == 3);
+  REQUIRE(v.Value() == 30);
+  REQUIRE(ob.callCount() == 1);
+  REQUIRE(ob.lastCallArgs() == std::pair{30, 0});
+
+  UpdateX(1);
+  REQUIRE(w.Value() == 4);
+  REQUIRE(v.Value() == 40);
+  REQUIRE(ob.callCount() == 2);
+  REQUIRE(ob.lastCallArgs() == std::pair{40, 30});
+}
+
+TEST_CASE("Batch update", "[Propagation]") {
+  MockObserver<int> obX;
+  MockObserver<int> obS;
+  auto [x, UpdateX] = Observable<int>::Mutable(0);
+  auto [y, UpdateY] = Observable<int>::Mutable(1);
+  auto [z, UpdateZ] = Observable<int>::Mutable(2);
+
+  auto sum = Monad<Observable>::Lift([](int a, int b, int c) {
+    return a + b + c;
+  }, x, y, z);
+  auto unobX = x.Observe(obX);
+  auto unobS = sum.Observe(obS);
+
+  Propagation::Batch([&]() {
+    UpdateX(3);
+    UpdateX(4);
+    UpdateY(5);
+    UpdateZ(6);
+    REQUIRE(x.Value() == 0);
+    REQUIRE(sum.Value() == 3);
+    REQUIRE(obX.callCount() == 0);
+    REQUIRE(obS.callCount() == 0);
+  });
+
+  REQUIRE(sum.Value() == 15);
+  REQUIRE(obX.callCount() == 1);
+  REQUIRE(obX.lastCallArgs() == std::pair{4, 0});
+  REQUIRE(obS.callCount() == 1);
+  REQUIRE(obS.lastCallArgs() == std::pair{15, 3});
+
+  // Nested batches are committed by the outermost one.
+  Propagation::Batch([&]() {
+    Propagation::Batch([&]() { UpdateX(0); });
+    REQUIRE(obS.callCount() == 1);
+    UpdateY(0);
+  });
+
+  REQUIRE(sum.Value() == 6);
+  REQUIRE(obS.callCount() == 2);
+  REQUIRE(obS.lastCallArgs() == std::pair{6, 15});
+}
+
+TEST_CASE("Throwing batch", "[Propagation]") {
+  MockObserver<int> obS;
+  auto [x, UpdateX] = Observable<int>::Mutable(0);
+  auto [y, UpdateY] = Observable<int>::Mutable(1);
+  auto [z, UpdateZ] = Observable<int>::Mutable(2);
+
+  auto sum = Combine([](int a, int b) { return a + b; }, x, y);
+  auto unobS = sum.Observe(obS);
+
+  // The updates staged before the throw are committed on the way out.
+  REQUIRE_THROWS_AS(Propagation::Batch([&]() {
+    Propagation::Batch([&]() {
+      UpdateX(3);
+      throw std::runtime_error("batch");
+    });
+  }), std::runtime_error);
+
+  REQUIRE(x.Value() == 3);
+  REQUIRE(sum.Value() == 4);
+  REQUIRE(obS.callCount() == 1);
+  REQUIRE(obS.lastCallArgs() == std::pair{4, 1});
+
+  // A later unrelated update doesn't carry them.
+  UpdateZ(5);
+  REQUIRE(obS.callCount() == 1);
+
+  UpdateY(2);
+  REQUIRE(obS.callCount() == 2);
+  REQUIRE(obS.lastCallArgs() == std::pair{5, 4});
+}
+
+TEST_CASE("Move-only values", "[Observable]") {
+  auto [x, updateX] = Observable<std::unique_ptr<int>>::Mutable(std::make_unique<int>(1));
+  auto y = Monad<Observable>::Map([](const std::unique_ptr<int> &p) { return *p * 10; }, x);
+  REQUIRE(y.Value() == 10);
+
+  updateX(std::make_unique<int>(2));
+  REQUIRE(*x.Value() == 2);
+  REQUIRE(y.Value() == 20);
+}
+
+TEST_CASE("Updates are moved", "[Observable]") {
+  std::size_t copies = 0;
+  auto [x, updateX] = Observable<CopyCounter>::Mutable(CopyCounter(1, copies));
+  int seen = 0;
+  auto unob = x.Observe([&seen](const CopyCounter &val, const CopyCounter &) { seen = val.Value(); });
+
+  updateX(CopyCounter(2, copies));
+  REQUIRE(seen == 2);
+  REQUIRE(x.Value().Value() == 2);
+  REQUIRE(copies == 0);
+}
+
+TEST_CASE("Lift doesn't copy the function on updates", "[Observable]") {
+  std::size_t copies = 0;
+  auto [x, UpdateX] = Observable<int>::Mutable(0);
+  auto [y, UpdateY] = Observable<int>::Mutable(1);
+  auto [z, UpdateZ] = Observable<int>::Mutable(2);
+
+  auto obs = Monad<Observable>::Lift([counter = CopyCounter(0, copies)](int a, int b, int c) {
+    return counter.Value() + a + b + c;
+  }, x, y, z);
+  REQUIRE(obs.Value() == 3);
+
+  UpdateX(3);
+  UpdateY(4);
+  UpdateZ(5);
+  REQUIRE(obs.Value() == 12);
+  REQUIRE(copies == 0);
+}
+
+TEST_CASE("Combine many inputs", "[Observable]") {
+  MockObserver<int> ob;
+  std::vector<Observable<int>> xs;
+  std::vector<Observable<int>::Updater> updates;
+  for (int i = 0; i < 10; i++) {
+    auto [x, UpdateX] = Observable<int>::Mutable(i);
+    xs.push_back(x);
+    updates.push_back(UpdateX);
+  }
+
+  auto obs = Combine([](int a, int b, int c, int d, int e, int f, int g, int h, int i, int j) {
+    return a + b + c + d + e + f + g + h + i + j;
+  }, xs[0], xs[1], xs[2], xs[3], xs[4], xs[5], xs[6], xs[7], xs[8], xs[9]);
+  REQUIRE(obs.Value() == 45);
+
+  auto unob = obs.Observe(ob);
+  updates[0](10);
+  REQUIRE(ob.callCount() == 1);
+  REQUIRE(ob.lastCallArgs() == std::pair{55, 45});
+  updates[9](19);
+  REQUIRE(ob.callCount() == 2);
+  REQUIRE(ob.lastCallArgs() == std::pair{65, 55});
+}
+
+TEST_CASE("Combine recomputes once per update", "[Observable]") {
+  int calls = 0;
+  auto [x, UpdateX] = Observable<int>::Mutable(1);
+  auto y = Monad<Observable>::Map([](int n) { return n * 10; }, x);
+  auto obs = Combine([&calls](int a, int b, int c) {
+    calls++;
+    return a + b + c;
+  }, x, y, x);
+  REQUIRE(obs.Value() == 12);
+  REQUIRE(calls == 1);
+
+  Propagation::Batch([&UpdateX]() { UpdateX(2); });
+  REQUIRE(obs.Value() == 24);
+  REQUIRE(calls == 2);
+}
+
+TEST_CASE("Combine doesn't rebuild the graph on updates", "[Observable]") {
+  auto [w, UpdateW] = Observable<int>::Mutable(0);
+  auto mapped = Monad<Observable>::Map([](int a) { return a + 1; }, w);
+  auto [x, UpdateX] = Observable<int>::Mutable(0);
+  auto [y, UpdateY] = Observable<int>::Mutable(1);
+  auto [z, UpdateZ] = Observable<int>::Mutable(2);
+  auto lifted = Monad<Observable>::Lift([](int a, int b, int c) {
+    return a + b + c;
+  }, x, y, z);
+
+  std::size_t allocations = Allocations();
+  UpdateW(1);
+  std::size_t mapAllocations = Allocations() - allocations;
+  REQUIRE(mapped.Value() == 2);
+
+  allocations = Allocations();
+  UpdateX(3);
+  REQUIRE(Allocations() - allocations == mapAllocations);
+  REQUIRE(lifted.Value() == 6);
+}
+
+TEST_CASE("Lazy recomputes only when read", "[Observable]") {
+  int calls = 0;
+  auto [x, UpdateX] = Observable<int>::Mutable(1);
+  auto [y, UpdateY] = Observable<int>::Mutable(2);
+  auto obs = Lazy([&calls](int a, int b) {
+    calls++;
+    return a + b;
+  }, x, y);
+  REQUIRE(calls == 1);
+
+  UpdateX(3);
+  UpdateY(4);
+  REQUIRE(calls == 1);
+  REQUIRE(obs.Value() == 7);
+  REQUIRE(calls == 2);
+  REQUIRE(obs.Value() == 7);
+  REQUIRE(calls == 2);
+
+  UpdateX(3);
+  REQUIRE(obs.Value() == 7);
+  REQUIRE(calls == 2);
+}
+
+TEST_CASE("Lazy is eager while observed", "[Observable]") {
+  int calls = 0;
+  MockObserver<int> ob;
+  auto [x, UpdateX] = Observable<int>::Mutable(1);
+  auto obs = Lazy([&calls](int a) {
+    calls++;
+    return a * 10;
+  }, x);
+
+  UpdateX(2);
+  auto unob = obs.Observe(ob);
+  REQUIRE(calls == 2);
+  REQUIRE(ob.callCount() == 0);
+
+  UpdateX(3);
+  REQUIRE(calls == 3);
+  REQUIRE(ob.callCount() == 1);
+  REQUIRE(ob.lastCallArgs() == std::pair{30, 20});
+
+  unob();
+  UpdateX(4);
+  UpdateX(5);
+  REQUIRE(calls == 3);
+  REQUIRE(ob.callCount() == 1);
+  REQUIRE(obs.Value() == 50);
+  REQUIRE(calls == 4);
+}
+
+TEST_CASE("Lazy chains", "[Observable]") {
+  int calls = 0;
+  auto [x, UpdateX] = Observable<int>::Mutable(0);
+  Observable<int> y = x;
+  for (int i = 0; i < 10; i++) {
+    y = Lazy([&calls](int a) {
+      calls++;
+      return a + 1;
+    }, y);
+  }
+  REQUIRE(calls == 10);
+
+  UpdateX(1);
+  REQUIRE(calls == 10);
+  REQUIRE(y.Value() == 11);
+  REQUIRE(calls == 20);
+
+  MockObserver<int> ob;
+  auto z = Monad<Observable>::Map([](int a) { return a * 2; }, y);
+  auto unob = z.Observe(ob);
+  UpdateX(2);
+  REQUIRE(calls == 30);
+  REQUIRE(ob.lastCallArgs() == std::pair{24, 22});
+}
+
+TEST_CASE("Lazy inputs of a combined node", "[Observable]") {
+  auto [x, UpdateX] = Observable<int>::Mutable(1);
+  auto lazy = Lazy([](int a) { return a + 1; }, x);
+  auto obs = Combine([](int a, int b) { return a + b; }, x, lazy);
+  REQUIRE(obs.Value() == 3);
+
+  Propagation::Batch([&UpdateX]() { UpdateX(2); });
+  REQUIRE(obs.Value() == 5);
+  REQUIRE(lazy.Value() == 3);
+}
+
+TEST_CASE("Change detection policies", "[Observable]") {
+  MockObserver<int> ob;
+  auto [x, UpdateX] = Observable<Versioned>::Mutable(Versioned{ 0, 0 });
+  auto xs = Monad<Observable>::Map([](const Versioned &v) { return v.value; }, x);
+  auto unobX = xs.Observe(ob);
+
+  UpdateX(Versioned{ 1, 0 });
+  REQUIRE(ob.callCount() == 0);
+  UpdateX(Versioned{ 1, 1 });
+  REQUIRE(ob.callCount() == 1);
+  REQUIRE(ob.lastCallArgs() == std::pair{1, 0});
+
+  int calls = 0;
+  auto [y, UpdateY] = Observable<Unequal>::Mutable(Unequal{ 0 });
+  auto unobY = y.Observe([&calls](const Unequal &, const Unequal &) { calls++; });
+  UpdateY(Unequal{ 0 });
+  UpdateY(Unequal{ 0 });
+  REQUIRE(calls == 2);
+}
+
+TEST_CASE("Modify in place", "[Observable]") {
+  std::size_t copies = 0;
+  auto [x, UpdateX] = Observable<CopyCounter>::Mutable(CopyCounter(0, copies));
+  auto y = Monad<Observable>::Map([](const CopyCounter &c) { return c.Value(); }, x);
+  MockObserver<int> ob;
+  auto unob = y.Observe(ob);
+
+  UpdateX.Modify([&copies](CopyCounter &c) { c = CopyCounter(c.Value() + 1, copies); });
+  REQUIRE(x.Value().Value() == 1);
+  REQUIRE(ob.lastCallArgs() == std::pair{1, 0});
+
+  UpdateX.Modify([](CopyCounter &) { return false; });
+  REQUIRE(ob.callCount() == 1);
+  REQUIRE(copies == 0);
+}
+
+TEST_CASE("Modify in a batch", "[Observable]") {
+  MockObserver<std::vector<int>> ob;
+  auto [x, UpdateX] = Observable<std::vector<int>>::Mutable(std::vector<int>{ 1 });
+  auto unob = x.Observe(ob);
+
+  Propagation::Batch([&UpdateX]() {
+    UpdateX.Modify([](std::vector<int> &v) { v.push_back(2); });
+    UpdateX.Modify([](std::vector<int> &v) { v.push_back(3); });
+  });
+  REQUIRE(ob.callCount() == 1);
+  REQUIRE(x.Value() == std::vector<int>{ 1, 2, 3 });
+
+  Propagation::Batch([&UpdateX]() {
+    UpdateX(std::vector<int>{ 4 });
+    UpdateX.Modify([](std::vector<int> &v) { v.push_back(5); });
+  });
+  REQUIRE(ob.callCount() == 2);
+  REQUIRE(ob.lastCallArgs() == std::pair{std::vector<int>{ 4, 5 }, std::vector<int>{ 1, 2, 3 }});
+}
+
+TEST_CASE("Coalesce", "[Observable]") {
+  using namespace std::chrono_literals;
+  ManualScheduler scheduler;
+  MockObserver<int> ob;
+  auto [x, UpdateX] = Observable<int>::Mutable(0);
+  auto y = Coalesce(x, scheduler);
+  auto unob = y.Observe(ob);
+
+  UpdateX(1);
+  UpdateX(2);
+  UpdateX(3);
+  REQUIRE(ob.callCount() == 0);
+  scheduler.Advance(0ms);
+  REQUIRE(ob.callCount() == 1);
+  REQUIRE(ob.lastCallArgs() == std::pair{3, 0});
+}
+
+TEST_CASE("Sample", "[Observable]") {
+  using namespace std::chrono_literals;
+  ManualScheduler scheduler;
+  MockObserver<int> ob;
+  auto [x, UpdateX] = Observable<int>::Mutable(0);
+  auto y = Sample(x, 10ms, scheduler);
+  auto unob = y.Observe(ob);
+
+  for (int i = 1; i <= 100; i++) {
+    UpdateX(i);
+    scheduler.Advance(1ms);
+  }
+  REQUIRE(ob.callCount() == 10);
+  REQUIRE(ob.nthCallArgs(0) == std::pair{10, 0});
+  REQUIRE(ob.lastCallArgs() == std::pair{100, 90});
+
+  scheduler.Advance(100ms);
+  REQUIRE(ob.callCount() == 10);
+}
+
+TEST_CASE("Throttle", "[Observable]") {
+  using namespace std::chrono_literals;
+  ManualScheduler scheduler;
+  MockObserver<int> ob;
+  auto [x, UpdateX] = Observable<int>::Mutable(0);
+  auto y = Throttle(x, 10ms, scheduler);
+  auto unob = y.Observe(ob);
+
+  UpdateX(1);
+  REQUIRE(ob.callCount() == 1);
+  REQUIRE(ob.lastCallArgs() == std::pair{1, 0});
+
+  scheduler.Advance(3ms);
+  UpdateX(2);
+  scheduler.Advance(3ms);
+  UpdateX(3);
+  REQUIRE(ob.callCount() == 1);
+  scheduler.Advance(4ms);
+  REQUIRE(ob.callCount() == 2);
+  REQUIRE(ob.lastCallArgs() == std::pair{3, 1});
+
+  scheduler.Advance(20ms);
+  UpdateX(4);
+  REQUIRE(ob.callCount() == 3);
+  REQUIRE(ob.lastCallArgs() == std::pair{4, 3});
+}
+
+TEST_CASE("Debounce", "[Observable]") {
+  using namespace std::chrono_literals;
+  ManualScheduler scheduler;
+  MockObserver<int> ob;
+  auto [x, UpdateX] = Observable<int>::Mutable(0);
+  auto y = Debounce(x, 10ms, scheduler);
+  auto unob = y.Observe(ob);
+
+  for (int i = 1; i <= 5; i++) {
+    UpdateX(i);
+    scheduler.Advance(5ms);
+  }
+  REQUIRE(ob.callCount() == 0);
+  scheduler.Advance(4ms);
+  REQUIRE(ob.callCount() == 0);
+  scheduler.Advance(1ms);
+  REQUIRE(ob.callCount() == 1);
+  REQUIRE(ob.lastCallArgs() == std::pair{5, 0});
+}
+
+TEST_CASE("Paced intervals must be positive", "[Observable]") {
+  using namespace std::chrono_literals;
+  ManualScheduler scheduler;
+  auto [x, UpdateX] = Observable<int>::Mutable(0);
+
+  REQUIRE_THROWS_AS(Sample(x, 0ms, scheduler), std::invalid_argument);
+  REQUIRE_THROWS_AS(Throttle(x, -1ms, scheduler), std::invalid_argument);
+  REQUIRE_THROWS_AS(Debounce(x, 0ms, scheduler), std::invalid_argument);
+  REQUIRE(Coalesce(x, scheduler).Value() == 0);
+}
+
+TEST_CASE("Paced observables stop with their owner", "[Observable]") {
+  using namespace std::chrono_literals;
+  ManualScheduler scheduler;
+  auto [x, UpdateX] = Observable<int>::Mutable(0);
+  {
+    auto y = Debounce(x, 10ms, scheduler);
+    UpdateX(1);
+  }
+  scheduler.Advance(10ms);
+  REQUIRE(x.Value() == 1);
+}
+
+TEST_CASE("Graphs on separate threads", "[Observable]") {
+  constexpr int updates = 10000;
+  auto run = [](int seed, int &last, std::size_t &calls) {
+    auto [x, UpdateX] = Observable<int>::Mutable(seed);
+    auto y = Monad<Observable>::Map([](int i) { return i + 1; }, x);
+    auto z = Monad<Observable>::Map([](int i) { return i * 2; }, x);
+    auto sum = Monad<Observable>::Lift([](int a, int b) { return a + b; }, y, z);
+    auto unob = sum.Observe([&](int newVal, int) {
+      last = newVal;
+      calls += 1;
+    });
+    for (int i = 1; i <= updates; i++) {
+      UpdateX(seed + i);
+    }
+  };
+
+  int last1 = 0, last2 = 0;
+  std::size_t calls1 = 0, calls2 = 0;
+  std::thread t1(run, 0, std::ref(last1), std::ref(calls1));
+  std::thread t2(run, 1000000, std::ref(last2), std::ref(calls2));
+  t1.join();
+  t2.join();
+
+  REQUIRE(calls1 == updates);
+  REQUIRE(calls2 == updates);
+  REQUIRE(last1 == (updates + 1) + updates * 2);
+  REQUIRE(last2 == (1000000 + updates) * 3 + 1);
+}
+
+TEST_CASE("Unobserve while notified", "[Observable]") {
+  auto [x, UpdateX] = Observable<int>::Mutable(0);
+  std::vector<int> calls;
+  std::optional<Observable<int>::Unobserve> unob1, unob2, unob3;
+  unob1.emplace(x.Observe([&](int, int) {
+    calls.push_back(1);
+    unob2 = std::nullopt;
+    // Drops this observer last, its captures go with it.
+    unob1 = std::nullopt;
+  }));
+  unob2.emplace(x.Observe([&](int, int) { calls.push_back(2); }));
+  unob3.emplace(x.Observe([&](int, int) { calls.push_back(3); }));
+
+  UpdateX(1);
+  UpdateX(2);
+  REQUIRE(calls == std::vector<int>{1, 3, 3});
+}
+
+TEST_CASE("Observer churn reuses nodes", "[Observable]") {
+  auto [x, UpdateX] = Observable<int>::Mutable(0);
+  auto y = Monad<Observable>::Map([](int i) { return i + 1; }, x);
+  int sum = 0;
+  x.Observe([&sum](int val, int) { sum += val; })();
+  y.Observe([&sum](int val, int) { sum += val; })();
+
+  std::size_t allocations = Allocations();
+  for (int i = 0; i < 100; i++) {
+    auto unobX = x.Observe([&sum](int val, int) { sum += val; });
+    auto unobY = y.Observe([&sum](int val, int) { sum += val; });
+  }
+  REQUIRE(Allocations() == allocations);
+
+  auto unob = y.Observe([&sum](int val, int) { sum += val; });
+  UpdateX(1);
+  REQUIRE(sum == 2);
+}
+
+class Widget {
+public:
+  Widget(): hook_([this](int val, int) { values.push_back(val); }) { }
+
+  void Bind(const Observable<int> &ob) { ob.Observe(hook_); }
+  void Unbind() { hook_.Unobserve(); }
+  bool Bound() const { return hook_.Observing(); }
+
+  std::vector<int> values;
+
+private:
+  Observable<int>::Hook hook_;
+};
+
+TEST_CASE("Observe with embedded hooks", "[Observable]") {
+  auto [x, UpdateX] = Observable<int>::Mutable(0);
+  auto [y, UpdateY] = Observable<int>::Mutable(0);
+  Widget widget;
+  widget.values.reserve(8);
+
+  std::size_t allocations = Allocations();
+  widget.Bind(x);
+  REQUIRE(widget.Bound());
+  widget.Unbind();
+  REQUIRE(!widget.Bound());
+  widget.Bind(x);
+  REQUIRE(Allocations() == allocations);
+
+  UpdateX(1);
+  widget.Bind(y);
+  UpdateX(2);
+  UpdateY(3);
+  REQUIRE(widget.values == std::vector<int>{1, 3});
+
+  {
+    Widget other;
+    other.Bind(y);
+    UpdateY(4);
+    REQUIRE(other.values == std::vector<int>{4});
+  }
+  UpdateY(5);
+  REQUIRE(widget.values == std::vector<int>{1, 3, 4, 5});
+}
+
+TEST_CASE("Hooks keep lazy observables attached", "[Observable]") {
+  int calls = 0;
+  auto [x, UpdateX] = Observable<int>::Mutable(1);
+  auto lazy = Lazy([&calls](int a) {
+    calls++;
+    return a + 1;
+  }, x);
+  Widget widget;
+  widget.Bind(lazy);
+  UpdateX(2);
+  REQUIRE(widget.values == std::vector<int>{3});
+  widget.Unbind();
+  UpdateX(3);
+  REQUIRE(calls == 2);
+  REQUIRE(lazy.Value() == 4);
+}
@@ -0,0 +1,83 @@
+#include <catch2/catch_test_macros.hpp>
+#include <cstdint>
+#include <optional>
+#include <set>
+#include <vector>
+#include "../pool-allocator.h"
+#include "../chain.h"
+
+TEST_CASE("Recycle released blocks", "[PoolAllocator]") {
+  PoolAllocator<double> alloc;
+
+  double *p1 = alloc.allocate(1);
+  double *p2 = alloc.allocate(1);
+  REQUIRE(p1 != p2);
+  REQUIRE(reinterpret_cast<std::uintptr_t>(p1) % alignof(double) == 0);
+  REQUIRE(reinterpret_cast<std::uintptr_t>(p2) % alignof(double) == 0);
+
+  alloc.deallocate(p1, 1);
+  REQUIRE(alloc.allocate(1) == p1);
+
+  alloc.deallocate(p1, 1);
+  alloc.deallocate(p2, 1);
+}
+
+TEST_CASE("Grow beyond a slab", "[PoolAllocator]") {
+  PoolAllocator<int> alloc;
+  std::vector<int *> blocks;
+  std::set<int *> unique;
+
+  for (int i = 0; i < 1000; i++) {
+    int *ptr = alloc.allocate(1);
+    *ptr = i;
+    blocks.push_back(ptr);
+    unique.insert(ptr);
+  }
+  REQUIRE(unique.size() == blocks.size());
+
+  for (int i = 0; i < 1000; i++) {
+    REQUIRE(*blocks[i] == i);
+    alloc.deallocate(blocks[i], 1);
+  }
+
+  // Steady state, the released blocks are handed out again.
+  for (int i = 0; i < 1000; i++) {
+    blocks[i] = alloc.allocate(1);
+    REQUIRE(unique.count(blocks[i]) == 1);
+  }
+  for (int *ptr : blocks) {
+    alloc.deallocate(ptr, 1);
+  }
+}
+
+TEST_CASE("Chain nodes from the pool", "[PoolAllocator]") {
+  Chain<int, PoolAllocator<int>> chain;
+  std::vector<int> values;
+
+  auto rm1 = chain.Add(1);
+  do {
+    auto rm2 = chain.Add(2);
+    chain.ForEach([&](int n) { values.push_back(n); });
+  } while (0);
+  auto rm3 = chain.Add(3);
+  chain.ForEach([&](int n) { values.push_back(n); });
+
+  REQUIRE(values == std::vector<int>{1, 2, 1, 3});
+}
+
+TEST_CASE("Chain nodes from a free list", "[PoolAllocator]") {
+  FreeList list;
+  Chain<int, FreeListAllocator<int>> chain(list);
+  std::vector<int> values;
+
+  std::optional<Chain<int, FreeListAllocator<int>>::Deleter> rm1;
+  rm1.emplace(chain.Add(1));
+  rm1 = std::nullopt;
+  // The released node is handed out again.
+  auto rm2 = chain.Add(2);
+  auto rm3 = chain.Add(3);
+  chain.ForEach([&](int n) { values.push_back(n); });
+
+  REQUIRE(values == std::vector<int>{2, 3});
+  REQUIRE(FreeListAllocator<int>(list) == FreeListAllocator<double>(list));
+}
@@ -1,4 +1,5 @@
 #include <catch2/catch_test_macros.hpp>
+#include <cstddef>
 #include <string>
 #include "../reader.h"
 #include "../pure-bind-monad.h"
@@ -61,3 +62,147 @@ TEST_CASE("Lift", "[Reader]") {
   REQUIRE(rD(1) == 5);
   REQUIRE(rD(2) == 11);
 }
+
+TEST_CASE("Deep bind chains", "[Reader]") {
+  constexpr int depth = 1000000;
+
+  auto r = Reader<int>::To<int>::Pure(0);
+  for (int i = 0; i < depth; i++) {
+    r = Monad<Reader<int>::To>::Bind(r, [](int v) {
+      return Reader<int>::To<int>([v](int n) { return v + n; });
+    });
+  }
+  REQUIRE(r(1) == depth);
+  REQUIRE(r(2) == 2 * depth);
+}
+
+TEST_CASE("From lvalue callable", "[Reader]") {
+  auto f = [](int n) { return n * 2; };
+  auto r = Reader<int>::To<int>(f);
+  REQUIRE(r(2) == 4);
+}
+
+TEST_CASE("Memoize", "[Reader]") {
+  int calls = 0;
+  auto r = Reader<int>::To<int>([&calls](int n) {
+    calls++;
+    return n * 10;
+  });
+  auto memo = Reader<int>::To<int>::Memoize(r, 2);
+
+  REQUIRE(memo(1) == 10);
+  REQUIRE(memo(1) == 10);
+  REQUIRE(calls == 1);
+  REQUIRE(memo(2) == 20);
+  REQUIRE(memo(1) == 10);
+  REQUIRE(calls == 2);
+
+  // Evicts 2, the least recently used.
+  REQUIRE(memo(3) == 30);
+  REQUIRE(memo(1) == 10);
+  REQUIRE(calls == 3);
+  REQUIRE(memo(2) == 20);
+  REQUIRE(calls == 4);
+}
+
+struct Config {
+  std::string name;
+  int revision;
+};
+
+TEST_CASE("Memoize with a key", "[Reader]") {
+  int calls = 0;
+  auto r = Reader<Config>::To<std::string>([&calls](const Config &config) {
+    calls++;
+    return config.name + "#" + std::to_string(config.revision);
+  });
+  auto memo = Reader<Config>::To<std::string>::Memoize(r, 8, [](const Config &config) {
+    return config.revision;
+  });
+
+  REQUIRE(memo(Config { "a", 1 }) == "a#1");
+  REQUIRE(memo(Config { "b", 1 }) == "a#1");
+  REQUIRE(memo(Config { "b", 2 }) == "b#2");
+  REQUIRE(calls == 2);
+}
+
+TEST_CASE("Shared sub-readers run once per call", "[Reader]") {
+  int calls = 0;
+  auto shared = Reader<int>::To<int>::Shared(Reader<int>::To<int>([&calls](int n) {
+    calls++;
+    return n + 1;
+  }));
+  auto doubled = Monad<Reader<int>::To>::Map([](int n) { return n * 2; }, shared);
+  auto r = Monad<Reader<int>::To>::Lift([](int a, int b, int c) { return a + b + c; }, shared, doubled, shared);
+
+  REQUIRE(r(1) == 8);
+  REQUIRE(calls == 1);
+  REQUIRE(r(2) == 12);
+  REQUIRE(calls == 2);
+  REQUIRE(shared(1) == 2);
+  REQUIRE(calls == 3);
+}
+
+TEST_CASE("Shared results are told apart by environment", "[Reader]") {
+  int calls = 0;
+  auto shared = Reader<int>::To<int>::Shared(Reader<int>::To<int>([&calls](int n) {
+    calls++;
+    return n * 10;
+  }));
+  // Both environments are temporaries, likely at the same address. A
+  // reader written by hand shares the results of the ones it runs once
+  // it is Shared itself.
+  auto r = Reader<int>::To<int>::Shared(Reader<int>::To<int>([shared](int n) {
+    return shared(n + 1) + shared(n + 2) + shared(n + 1);
+  }));
+
+  REQUIRE(r(0) == 40);
+  REQUIRE(calls == 2);
+
+  auto byRevision = Reader<Config>::To<int>::Shared(Reader<Config>::To<int>([&calls](const Config &config) {
+    calls++;
+    return config.revision;
+  }), [](const Config &config) { return config.revision; });
+  auto s = Reader<Config>::To<int>::Shared(Reader<Config>::To<int>([byRevision](const Config &config) {
+    return byRevision(config) + byRevision(Config { "other", config.revision }) + byRevision(Config { "next", 2 });
+  }), [](const Config &config) { return config.name; });
+
+  REQUIRE(s(Config { "a", 1 }) == 4);
+  REQUIRE(calls == 4);
+}
+
+TEST_CASE("Lift shares the results of any of its readers", "[Reader]") {
+  int calls = 0;
+  auto shared = Reader<int>::To<int>::Shared(Reader<int>::To<int>([&calls](int n) {
+    calls++;
+    return n + 1;
+  }));
+  auto plain = Reader<int>::To<int>([](int n) { return n * 2; });
+  auto r = Monad<Reader<int>::To>::Lift([](int a, int b, int c) { return a + b + c; }, plain, shared, shared);
+
+  REQUIRE(r(1) == 6);
+  REQUIRE(calls == 1);
+  REQUIRE(plain(1) == 2);
+}
+
+TEST_CASE("Shared readers may run inside the key comparison", "[Reader]") {
+  int calls = 0;
+  auto inner = Reader<int>::To<int>::Shared(Reader<int>::To<int>([&calls](int n) {
+    calls++;
+    return n;
+  }));
+  // Each comparison shares a hundred more results, which grows the
+  // buckets while the outer results are being looked up.
+  auto eq = [inner](int a, int b) {
+    int sum = 0;
+    for (int k = 0; k < 100; k++) {
+      sum += inner(a * 1000 + k);
+    }
+    return sum >= 0 && a == b;
+  };
+  auto outer = Reader<int>::To<int>::Shared(Reader<int>::To<int>([](int n) { return n * 10; }), std::identity(), eq);
+  auto r = Monad<Reader<int>::To>::Lift([](int a, int b, int c) { return a + b + c; }, outer, outer, outer);
+
+  REQUIRE(r(2) == 60);
+  REQUIRE(calls == 100);
+}
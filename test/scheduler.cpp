@@ -0,0 +1,35 @@
+#include <catch2/catch_test_macros.hpp>
+#include <chrono>
+#include <vector>
+
+#include "../scheduler.h"
+
+TEST_CASE("Manual scheduler runs works in time order", "[Scheduler]") {
+  using namespace std::chrono_literals;
+  ManualScheduler scheduler;
+  IScheduler::Clock::time_point start = scheduler.Now();
+  std::vector<int> runs;
+
+  scheduler.PostAt(start + 20ms, [&runs]() { runs.push_back(2); });
+  scheduler.PostAt(start + 10ms, [&runs, &scheduler, start]() {
+    REQUIRE(scheduler.Now() == start + 10ms);
+    runs.push_back(1);
+    scheduler.PostAt(scheduler.Now() + 5ms, [&runs]() { runs.push_back(3); });
+  });
+
+  scheduler.Advance(9ms);
+  REQUIRE(runs.empty());
+  scheduler.Advance(11ms);
+  REQUIRE(runs == std::vector<int>{ 1, 3, 2 });
+  REQUIRE(scheduler.Now() == start + 20ms);
+}
+
+TEST_CASE("Polled scheduler runs due works", "[Scheduler]") {
+  using namespace std::chrono_literals;
+  PolledScheduler scheduler;
+  int n = 0;
+  scheduler.PostAt(scheduler.Now(), [&n]() { n++; });
+  scheduler.PostAt(scheduler.Now() + 1h, [&n]() { n++; });
+  scheduler.RunDue();
+  REQUIRE(n == 1);
+}
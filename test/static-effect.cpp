@@ -0,0 +1,59 @@
+#include <catch2/catch_test_macros.hpp>
+#include <string>
+#include "../static-effect.h"
+#include "./allocations.h"
+
+TEST_CASE("Execute static effect", "[StaticEffect]") {
+  int n = 10;
+  auto eff = StaticEffect([&n]() { return n++; });
+  REQUIRE(eff() == 10);
+  REQUIRE(eff() == 11);
+  REQUIRE(PureEffect(1)() == 1);
+}
+
+TEST_CASE("Static effect Map and Bind", "[StaticEffect]") {
+  int n = 10;
+  auto eff = StaticEffect([&n]() { return n++; })
+    .Map([](int v) { return v * 2; })
+    .Bind([&n](int v) { return StaticEffect([v, &n]() { return v + n++; }); })
+    .Map([](int v) { return std::to_string(v); });
+
+  REQUIRE(eff() == "31");
+  REQUIRE(n == 12);
+  REQUIRE(eff() == "37");
+  REQUIRE(n == 14);
+}
+
+TEST_CASE("Static effect binds erased effects", "[StaticEffect]") {
+  auto eff = PureEffect(1).Bind([](int v) { return Effect<int>::Pure(v + 1); });
+  REQUIRE(eff() == 2);
+}
+
+TEST_CASE("Erase static effect", "[StaticEffect]") {
+  int n = 0;
+  Effect<int> eff = PureEffect(1).Map([](int v) { return v + 1; }).Erase();
+  REQUIRE(eff() == 2);
+
+  Effect<> unit = StaticEffect([&n]() { n++; }).Map([&n]() { n++; }).Erase();
+  unit();
+  REQUIRE(n == 2);
+}
+
+TEST_CASE("Static effect pipelines don't allocate", "[StaticEffect]") {
+  std::size_t allocations = Allocations();
+  int n = 0;
+  auto eff = StaticEffect([&n]() { return n++; })
+    .Map([](int v) { return v + 1; })
+    .Bind([](int v) { return PureEffect(v * 2); });
+  REQUIRE(eff() == 2);
+  REQUIRE(eff() == 4);
+  REQUIRE(Allocations() == allocations);
+}
+
+TEST_CASE("Compile-time static effects", "[StaticEffect]") {
+  constexpr auto eff = PureEffect(20)
+    .Map([](int v) { return v + 1; })
+    .Bind([](int v) { return PureEffect(v * 2); });
+  static_assert(eff() == 42);
+  REQUIRE(eff() == 42);
+}
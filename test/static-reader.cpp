@@ -0,0 +1,51 @@
+#include <catch2/catch_test_macros.hpp>
+#include <string>
+#include "../static-reader.h"
+#include "./allocations.h"
+
+TEST_CASE("Static reader as pure function", "[StaticReader]") {
+  auto r = StaticReader<int>::To([](int n) { return n + 1; });
+  REQUIRE(r(1) == 2);
+  REQUIRE(StaticReader<int>::Pure(42)(1) == 42);
+}
+
+TEST_CASE("Static reader Map and Bind", "[StaticReader]") {
+  auto r = StaticReader<int>::To([](int n) { return n + 1; })
+    .Map([](int v) { return v * 2; })
+    .Bind([](int v) { return StaticReader<int>::To([v](int n) { return v + n; }); })
+    .Map([](int v) { return std::to_string(v); });
+  REQUIRE(r(1) == "5");
+  REQUIRE(r(2) == "8");
+}
+
+TEST_CASE("Static reader binds erased readers", "[StaticReader]") {
+  auto r = StaticReader<int>::Pure(1).Bind([](int v) {
+    return Reader<int>::To<int>([v](int n) { return v + n; });
+  });
+  REQUIRE(r(2) == 3);
+}
+
+TEST_CASE("Erase static reader", "[StaticReader]") {
+  Reader<int>::To<std::string> r = StaticReader<int>::To([](int n) { return n * 3; })
+    .Map([](int v) { return std::to_string(v); })
+    .Erase();
+  REQUIRE(r(2) == "6");
+}
+
+TEST_CASE("Static reader pipelines don't allocate", "[StaticReader]") {
+  std::size_t allocations = Allocations();
+  auto r = StaticReader<int>::To([](int n) { return n + 1; })
+    .Map([](int v) { return v * 2; })
+    .Bind([](int v) { return StaticReader<int>::To([v](int n) { return v + n; }); });
+  REQUIRE(r(1) == 5);
+  REQUIRE(Allocations() == allocations);
+}
+
+TEST_CASE("Compile-time static readers", "[StaticReader]") {
+  constexpr auto r = StaticReader<int>::To([](int i) { return i + 1; })
+    .Bind([](int n) { return StaticReader<int>::To([n](int i) { return n * i; }); })
+    .Map([](int n) { return n - 1; });
+  static_assert(r(3) == 11);
+  static_assert(StaticReader<int>::Pure(7)(0) == 7);
+  REQUIRE(r(3) == 11);
+}
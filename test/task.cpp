@@ -1,5 +1,13 @@
 #include <catch2/catch_test_macros.hpp>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <stop_token>
 #include <iostream>
+#include <string>
+#include <tuple>
+#include <vector>
+#include "../pure-bind-monad.h"
 #include "../task2.h"
 
 TEST_CASE("Execute task", "[Task]") {
@@ -21,3 +29,199 @@ TEST_CASE("Execute task", "[Task]") {
 
   REQUIRE(to == 2);
 }
+
+TEST_CASE("Bind task", "[Task]") {
+  int to = 0;
+
+  auto task = Task<int>::Bind(Task<int>::Pure(20), [](int n) {
+    return Task<int>::Pure(n + 1);
+  });
+  task([&to](int n) { return [&to, n](){ to = n; }; });
+  REQUIRE(to == 21);
+}
+
+TEST_CASE("Deep bind chains", "[Task]") {
+  constexpr int depth = 1000000;
+  int to = 0;
+
+  auto task = Task<int>::Pure(0);
+  for (int i = 0; i < depth; i++) {
+    task = Task<int>::Bind(task, [](int n) { return Task<int>::Pure(n + 1); });
+  }
+  task([&to](int n) { return [&to, n](){ to = n; }; });
+  REQUIRE(to == depth);
+}
+
+TEST_CASE("Bind asynchronous tasks", "[Task]") {
+  std::vector<std::function<void()>> pending;
+  int to = 0;
+
+  auto later = [&pending](int n) {
+    return Task<int>([&pending, n](const Task<int>::Callback &cb) {
+      pending.push_back([cb, n]() { cb(n)(); });
+      return [](){};
+    });
+  };
+
+  auto task = Task<int>::Bind(later(1), [&later](int n) {
+    return Task<int>::Bind(later(n + 1), [](int n) { return Task<int>::Pure(n * 10); });
+  });
+  task([&to](int n) { return [&to, n](){ to = n; }; });
+  REQUIRE(to == 0);
+  REQUIRE(pending.size() == 1);
+
+  pending[0]();
+  REQUIRE(to == 0);
+  REQUIRE(pending.size() == 2);
+
+  pending[1]();
+  REQUIRE(to == 20);
+}
+
+TEST_CASE("WhenAll", "[Task]") {
+  std::tuple<int, std::string> to;
+  int calls = 0;
+
+  auto task = WhenAll(Task<int>::Pure(1), Task<std::string>::Pure("2"));
+  task([&](const std::tuple<int, std::string> &val) {
+    return [&, val]() {
+      calls++;
+      to = val;
+    };
+  });
+  REQUIRE(calls == 1);
+  REQUIRE(to == std::tuple<int, std::string>{1, "2"});
+
+  std::vector<int> all;
+  auto tasks = WhenAll(std::vector<Task<int>>{ Task<int>::Pure(1), Task<int>::Pure(2), Task<int>::Pure(3) });
+  tasks([&all](const std::vector<int> &val) { return [&all, val]() { all = val; }; });
+  REQUIRE(all == std::vector<int>{1, 2, 3});
+
+  tasks = WhenAll(std::vector<Task<int>>{});
+  tasks([&all](const std::vector<int> &val) { return [&all, val]() { all = val; }; });
+  REQUIRE(all.empty());
+}
+
+TEST_CASE("WhenAll asynchronous tasks", "[Task]") {
+  std::vector<std::function<void()>> pending;
+  std::vector<int> all;
+
+  auto later = [&pending](int n) {
+    return Task<int>([&pending, n](const Task<int>::Callback &cb) {
+      pending.push_back([cb, n]() { cb(n)(); });
+      return [](){};
+    });
+  };
+
+  auto task = WhenAll(std::vector<Task<int>>{ later(1), later(2), later(3) });
+  task([&all](const std::vector<int> &val) { return [&all, val]() { all = val; }; });
+
+  // All the children are started at once.
+  REQUIRE(pending.size() == 3);
+
+  pending[2]();
+  pending[0]();
+  REQUIRE(all.empty());
+  pending[1]();
+  REQUIRE(all == std::vector<int>{1, 2, 3});
+}
+
+TEST_CASE("WhenAny", "[Task]") {
+  std::vector<std::function<void()>> pending;
+  std::vector<int> all;
+
+  auto later = [&pending](int n) {
+    return Task<int>([&pending, n](const Task<int>::Callback &cb) {
+      pending.push_back([cb, n]() { cb(n)(); });
+      return [](){};
+    });
+  };
+
+  auto task = WhenAny(later(1), later(2), later(3));
+  task([&all](int val) { return [&all, val]() { all.push_back(val); }; });
+  REQUIRE(pending.size() == 3);
+
+  pending[1]();
+  pending[0]();
+  pending[2]();
+  REQUIRE(all == std::vector<int>{2});
+}
+
+TEST_CASE("Stop releases continuations", "[Task]") {
+  std::optional<Task<int>::Callback> pending;
+  auto state = std::make_shared<int>(1);
+  std::weak_ptr<int> weak = state;
+  std::vector<int> all;
+
+  auto later = Task<int>([&pending](const Task<int>::Callback &cb) {
+    pending = cb;
+    return [](){};
+  });
+  auto task = Task<int>::Bind(later, [](int n) { return Task<int>::Pure(n + 1); });
+
+  std::stop_source source;
+  task([&all, state = std::move(state)](int val) {
+    return [&all, val]() { all.push_back(val); };
+  }, source.get_token())();
+  REQUIRE(!weak.expired());
+
+  source.request_stop();
+  REQUIRE(weak.expired());
+  pending.value()(1)();
+  REQUIRE(all.empty());
+}
+
+TEST_CASE("Stopped task doesn't start", "[Task]") {
+  int runs = 0;
+  auto task = Task<int>::Bind(Task<int>([&runs](const Task<int>::Callback &cb) {
+    runs++;
+    return cb(1);
+  }), [](int n) { return Task<int>::Pure(n); });
+
+  std::stop_source source;
+  source.request_stop();
+  task([](int) { return [](){}; }, source.get_token())();
+  REQUIRE(runs == 0);
+}
+
+TEST_CASE("WhenAny stops the other tasks", "[Task]") {
+  std::vector<std::function<void()>> pending;
+  std::vector<int> continued;
+  std::vector<int> all;
+
+  auto later = [&pending, &continued](int n) {
+    return Task<int>::Bind(Task<int>([&pending, n](const Task<int>::Callback &cb) {
+      pending.push_back([cb, n]() { cb(n)(); });
+      return [](){};
+    }), [&continued](int n) {
+      continued.push_back(n);
+      return Task<int>::Pure(n);
+    });
+  };
+
+  auto task = WhenAny(later(1), later(2));
+  task([&all](int val) { return [&all, val]() { all.push_back(val); }; })();
+  REQUIRE(pending.size() == 2);
+
+  pending[1]();
+  pending[0]();
+  REQUIRE(continued == std::vector<int>{2});
+  REQUIRE(all == std::vector<int>{2});
+}
+
+TEST_CASE("Map asynchronous task", "[Task]") {
+  std::optional<Task<int>::Callback> pending;
+  std::vector<std::string> all;
+
+  auto later = Task<int>([&pending](const Task<int>::Callback &cb) {
+    pending = cb;
+    return [](){};
+  });
+  auto task = Monad<Task>::Map([](int v) { return std::to_string(v); },
+    Monad<Task>::Map([](int v) { return v * 2; }, later));
+
+  task([&all](const std::string &val) { return [&all, val]() { all.push_back(val); }; })();
+  REQUIRE(all.empty());
+  pending.value()(21)();
+  REQUIRE(all == std::vector<std::string>{"42"});
+}
@@ -0,0 +1,204 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "./erased.h"
+
+template <typename Signature> class Trampoline;
+
+// Keeps chains of binds as data so that they are built and run in
+// constant stack space.
+//
+// A step is a leaf computation `R(Args...)` followed by the continuations
+// bound after it, the latest first. Binding only links a new
+// continuation in front of the step, and the interpreter unwinds the
+// continuations onto an explicit stack and applies them in a loop. The
+// values crossing a bind are erased, see erased.h.
+//
+// A map is a continuation transforming the value in place, without a
+// step of its own. Up to `Fused` consecutive maps fuse into one stage:
+// the last map of a run stands for the whole run on the stack, and the
+// interpreter applies the maps of the run in a flat loop. A chain of maps
+// runs and is released in constant stack space too.
+template <typename R, typename... Args>
+class Trampoline<R(Args...)> final
+{
+public:
+  class Node;
+  class MapNode;
+  using Step = std::shared_ptr<const Node>;
+  using Stack = std::vector<Step>;
+
+  // The most maps applied as one stage.
+  static constexpr std::size_t Fused = 16;
+
+  class Node
+  {
+  public:
+    Node(Step prev): Node(std::move(prev), false) { }
+
+    Node(const Node &) = delete;
+    Node & operator = (const Node &) = delete;
+
+    // A long chain would overflow the stack when released recursively.
+    virtual ~Node() {
+      Step prev = std::move(prev_);
+      while (prev && prev.use_count() == 1) {
+        Step next = std::move(prev->prev_);
+        prev = std::move(next);
+      }
+    }
+
+    virtual const MapNode *AsMap() const { return nullptr; }
+
+  protected:
+    // A map joins the stage of the maps right before it, unless full.
+    Node(Step prev, bool map):
+      fused_(map && prev && prev->AsMap() != nullptr && prev->fused_ + 1 < Fused ? prev->fused_ + 1 : 0),
+      depth_(!prev ? 0 : fused_ > 0 ? prev->depth_ : prev->depth_ + 1),
+      prev_(std::move(prev)) { }
+
+  private:
+    friend class Trampoline;
+    // The number of maps before this one in its stage.
+    std::size_t fused_;
+    // The number of stages before the leaf.
+    std::size_t depth_;
+    mutable Step prev_;
+  };
+
+  // The last node of a step is always a leaf, all the others are binds.
+  class LeafNode: public Node
+  {
+  public:
+    LeafNode(): Node(nullptr) { }
+    virtual R Invoke(Args... args) const = 0;
+  };
+
+  class BindNode: public Node
+  {
+  public:
+    BindNode(Step prev): Node(std::move(prev)) { }
+    virtual Step Continue(Erased &&value) const = 0;
+  };
+
+  class MapNode: public Node
+  {
+  public:
+    MapNode(Step prev): Node(std::move(prev), true) { }
+    virtual void Apply(Erased &value) const = 0;
+    virtual const MapNode *AsMap() const override { return this; }
+  };
+
+  template <typename F>
+  static Step Leaf(F &&f) {
+    class Impl: public LeafNode
+    {
+    public:
+      Impl(F &&f): f_(std::forward<F>(f)) { }
+      virtual R Invoke(Args... args) const override { return f_(std::forward<Args>(args)...); }
+    private:
+      std::decay_t<F> f_;
+    };
+
+    return std::make_shared<const Impl>(std::forward<F>(f));
+  }
+
+  // `k` maps the erased value produced by `step` to the next step.
+  template <typename F>
+  static Step Bind(Step step, F &&k) {
+    class Impl: public BindNode
+    {
+    public:
+      Impl(Step prev, F &&k): BindNode(std::move(prev)), k_(std::forward<F>(k)) { }
+      virtual Step Continue(Erased &&value) const override { return k_(std::move(value)); }
+    private:
+      std::decay_t<F> k_;
+    };
+
+    return std::make_shared<const Impl>(std::move(step), std::forward<F>(k));
+  }
+
+  // `f` maps the `U` produced by `step` to a `T`, which replaces it in the
+  // erased value. A map keeping the type assigns the value in place.
+  template <typename U, typename T, typename F>
+  static Step Map(Step step, F &&f) {
+    class Impl: public MapNode
+    {
+    public:
+      Impl(Step prev, F &&f): MapNode(std::move(prev)), f_(std::forward<F>(f)) { }
+      virtual void Apply(Erased &value) const override {
+        if constexpr (std::is_same_v<U, T>) {
+          value.Get<T>() = T(f_(value.Take<U>()));
+        } else {
+          value = Erased(T(f_(value.Take<U>())));
+        }
+      }
+    private:
+      std::decay_t<F> f_;
+    };
+
+    return std::make_shared<const Impl>(std::move(step), std::forward<F>(f));
+  }
+
+  // Pushes the stages of `step` onto `stack`, the first to apply on top,
+  // and returns its leaf. The leaf lives as long as `step`. The stack
+  // grows once per unwinding, however long the chain.
+  static const LeafNode &Unwind(const Step &step, Stack &stack) {
+    if (std::size_t size = stack.size() + step->depth_; size > stack.capacity()) {
+      stack.reserve(std::max(size, 2 * stack.capacity()));
+    }
+    const Step *node = &step;
+    while ((*node)->prev_) {
+      stack.push_back(*node);
+      for (std::size_t i = (*node)->fused_; i > 0; i--) {
+        node = &(*node)->prev_;
+      }
+      node = &(*node)->prev_;
+    }
+    return static_cast<const LeafNode &>(**node);
+  }
+
+  // Applies the maps on top of `stack` to `value` in place, then the bind
+  // below them, and returns the step it produces. Returns null when the
+  // stack runs out, `value` is then the final value.
+  static Step Continue(Stack &stack, Erased &value) {
+    while (!stack.empty()) {
+      Step next = std::move(stack.back());
+      stack.pop_back();
+      if (const MapNode *map = next->AsMap()) {
+        // The last map of the stage keeps the others alive.
+        const MapNode *stage[Fused];
+        std::size_t size = map->fused_ + 1;
+        stage[size - 1] = map;
+        for (std::size_t i = size - 1; i > 0; i--) {
+          map = static_cast<const MapNode *>(map->prev_.get());
+          stage[i - 1] = map;
+        }
+        for (std::size_t i = 0; i < size; i++) {
+          stage[i]->Apply(value);
+        }
+      } else {
+        return static_cast<const BindNode &>(*next).Continue(std::move(value));
+      }
+    }
+    return nullptr;
+  }
+
+  // The interpreter for leaves returning their erased value directly.
+  template <typename... A>
+  static Erased Run(Step step, A &&... args) {
+    Stack stack;
+    while (true) {
+      Erased value = Unwind(step, stack).Invoke(args...);
+      step = Continue(stack, value);
+      if (!step) {
+        return value;
+      }
+    }
+  }
+};